@@ -0,0 +1,103 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./ballot-trie.h"
+#include <cassert>
+#include <algorithm>
+#include "./vote.h"
+
+using std::vector;
+using std::sort;
+using std::lexicographical_compare;
+using std::mismatch;
+using std::max;
+
+namespace bush {
+
+template<class VoteType>
+const int BallotTrie<VoteType>::kRoot;
+
+template<class VoteType>
+const int BallotTrie<VoteType>::kNoTail;
+
+template<class VoteType>
+BallotTrie<VoteType>::BallotTrie(const VoteType& vote) {
+  const int num_candidates = vote.num_candidates();
+  const Id* ballots = vote.ballots().data();
+  // Ballots in lexicographic order share their prefixes with their
+  // neighbours, the trie is built in a single pass.
+  vector<int> order;
+  order.reserve(vote.num_ballots());
+  for (int b = 0; b < vote.num_ballots(); ++b) {
+    if (vote.count(b)) {
+      order.push_back(b);
+    }
+  }
+  sort(order.begin(), order.end(), [=](const int lhs, const int rhs) {
+    const Id* lhs_row = ballots + static_cast<size_t>(lhs) * num_candidates;
+    const Id* rhs_row = ballots + static_cast<size_t>(rhs) * num_candidates;
+    return lexicographical_compare(lhs_row, lhs_row + num_candidates,
+                                   rhs_row, rhs_row + num_candidates);
+  });
+  // Lengths of the common prefixes of neighbouring ballots.
+  const int num_rows = order.size();
+  vector<int> shared(num_rows + 1, 0);
+  for (int i = 1; i < num_rows; ++i) {
+    const Id* prev = ballots + static_cast<size_t>(order[i - 1]) *
+                     num_candidates;
+    const Id* row = ballots + static_cast<size_t>(order[i]) * num_candidates;
+    shared[i] = mismatch(row, row + num_candidates, prev).first - row;
+  }
+  AddNode(-1, vote.num_voters(), nullptr, nullptr);
+  // The inner nodes along the path of the current ballot by depth.
+  vector<int> path;
+  for (int i = 0; i < num_rows; ++i) {
+    const int ballot = order[i];
+    const Id* row = ballots + static_cast<size_t>(ballot) * num_candidates;
+    const int count = vote.count(ballot);
+    // The previous ballot's deeper inner nodes are complete.
+    while (static_cast<int>(path.size()) > shared[i]) {
+      ends_[path.back()] = num_nodes();
+      path.pop_back();
+    }
+    for (auto it = path.cbegin(), end = path.cend(); it != end; ++it) {
+      counts_[*it] += count;
+    }
+    // Inner nodes for the prefix shared with the next ballot, the tail for
+    // the rest. The ballots of a vote are distinct.
+    const int depth = max(shared[i], shared[i + 1]);
+    assert(depth < num_candidates);
+    for (int d = shared[i]; d < depth; ++d) {
+      path.push_back(AddNode(row[d], count, nullptr, nullptr));
+    }
+    AddNode(row[depth], count, row + depth, row + num_candidates);
+  }
+  while (!path.empty()) {
+    ends_[path.back()] = num_nodes();
+    path.pop_back();
+  }
+  ends_[kRoot] = num_nodes();
+}
+
+template<class VoteType>
+int BallotTrie<VoteType>::AddNode(const int candidate, const int count,
+                                  const Id* tail_begin, const Id* tail_end) {
+  const int node = num_nodes();
+  candidates_.push_back(candidate);
+  counts_.push_back(count);
+  // Tails have no children, the ends of inner nodes are set once their
+  // subtrees are complete.
+  ends_.push_back(node + 1);
+  if (tail_begin) {
+    tail_offsets_.push_back(tail_rows_.size());
+    tail_sizes_.push_back(tail_end - tail_begin);
+    tail_rows_.insert(tail_rows_.end(), tail_begin, tail_end);
+  } else {
+    tail_offsets_.push_back(kNoTail);
+    tail_sizes_.push_back(0);
+  }
+  return node;
+}
+
+template class BallotTrie<Vote>;
+template class BallotTrie<CompactVote>;
+
+}  // namespace bush
@@ -0,0 +1,88 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_BALLOT_TRIE_H_
+#define SRC_BALLOT_TRIE_H_
+
+#include <vector>
+
+namespace bush {
+
+// Prefix trie of the ballots of a vote, each node counts the voters whose
+// ballots share the prefix up to its candidate. A prefix of a single ballot
+// ends in a tail node, which stands for the rest of the ballot's row instead
+// of a chain of nodes. The rows of the tails are copied in trie order. The
+// nodes are stored in depth-first order, each subtree occupies a contiguous
+// node range and the children of a node follow it in increasing candidate
+// order. The root is node 0 and has no candidate.
+//
+// An instant-runoff count on the trie keeps a frontier of nodes, the topmost
+// nodes of active candidates. An elimination moves the children of the
+// eliminated candidate's frontier nodes, so whole subtrees of ballots are
+// transferred at once and a count scales with the number of distinct
+// prefixes instead of the number of voters or ballots.
+template<class VoteType>
+class BallotTrie {
+ public:
+  typedef typename VoteType::IdType Id;
+
+  static const int kRoot = 0;
+
+  explicit BallotTrie(const VoteType& vote);
+
+  // Returns the candidate of the node, the first candidate of a tail.
+  int candidate(const int node) const {
+    return candidates_[node];
+  }
+
+  // Returns the number of voters whose ballots pass through the node.
+  int count(const int node) const {
+    return counts_[node];
+  }
+
+  // Returns the first child of the node, equal to its end if it has none.
+  int first_child(const int node) const {
+    return node + 1;
+  }
+
+  // Returns the end of the node's subtree, which is also the next sibling of
+  // the node if it has one.
+  int end(const int node) const {
+    return ends_[node];
+  }
+
+  // Returns whether the node is a tail.
+  bool tail(const int node) const {
+    return tail_offsets_[node] != kNoTail;
+  }
+
+  // Returns the rest of the tail node's ballot row, starting with its
+  // candidate.
+  const Id* tail_row(const int node) const {
+    return tail_rows_.data() + tail_offsets_[node];
+  }
+
+  // Returns the number of candidates in the tail node's row.
+  int tail_size(const int node) const {
+    return tail_sizes_[node];
+  }
+
+  int num_nodes() const {
+    return candidates_.size();
+  }
+
+ private:
+  static const int kNoTail = -1;
+
+  // Appends a node and returns it. A tail node gets the given row.
+  int AddNode(const int candidate, const int count, const Id* tail_begin,
+              const Id* tail_end);
+
+  std::vector<int> candidates_;
+  std::vector<int> counts_;
+  std::vector<int> ends_;
+  std::vector<int> tail_offsets_;
+  std::vector<int> tail_sizes_;
+  std::vector<Id> tail_rows_;
+};
+
+}  // namespace bush
+#endif  // SRC_BALLOT_TRIE_H_
@@ -0,0 +1,201 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./binary-format.h"
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::ofstream;
+
+namespace bush {
+
+const char BinaryFormat::kMagic[4] = {'B', 'U', 'S', 'H'};
+const uint32_t BinaryFormat::kVersion;
+
+// Returns the size in bytes of the padded ballots section.
+static size_t BallotsSize(const BinaryFormat::Header& header) {
+  const size_t size = static_cast<size_t>(header.num_ballots) *
+                      header.num_candidates * header.id_width;
+  return (size + 3) / 4 * 4;
+}
+
+// Copies the candidate ids of the stored ballot into the row. Returns false
+// if the ballot is not a permutation of the candidates, seen holds the last
+// ballot stamp per candidate.
+template<typename Id>
+static bool ReadBallot(const char* data, const int stamp, vector<int>* row,
+                       vector<int>* seen) {
+  const Id* ids = reinterpret_cast<const Id*>(data);
+  const int num_candidates = row->size();
+  for (int c = 0; c < num_candidates; ++c) {
+    const int id = ids[c];
+    if (id >= num_candidates || (*seen)[id] == stamp) {
+      return false;
+    }
+    (*seen)[id] = stamp;
+    (*row)[c] = id;
+  }
+  return true;
+}
+
+bool BinaryFormat::IsBinary(const char* data, const size_t size) {
+  return size >= sizeof(Header) && memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+int BinaryFormat::NumCandidates(const char* data, const size_t size) {
+  assert(IsBinary(data, size));
+  Header header;
+  memcpy(&header, data, sizeof(header));
+  return header.num_candidates;
+}
+
+template<class VoteType>
+VoteType BinaryFormat::Read(const char* data, const size_t size,
+                           string* error) {
+  assert(IsBinary(data, size));
+  Header header;
+  memcpy(&header, data, sizeof(header));
+  const bool weighted = header.flags & kWeighted;
+  if (header.version != kVersion) {
+    *error = "unsupported binary format version";
+    return VoteType(0, 0);
+  } else if (header.num_candidates < 1 ||
+             (header.id_width != 1 && header.id_width != 2) ||
+             (header.id_width == 1 &&
+              header.num_candidates >
+                  static_cast<uint32_t>(CompactVote::MaxCandidates())) ||
+             (!weighted && header.num_ballots != header.num_voters)) {
+    *error = "invalid binary header";
+    return VoteType(0, 0);
+  } else if (header.num_candidates >
+             static_cast<uint32_t>(VoteType::MaxCandidates())) {
+    *error = "too many candidates";
+    return VoteType(0, 0);
+  } else if (header.num_voters > static_cast<uint32_t>(
+                 VoteType::MaxVoters(header.num_candidates))) {
+    *error = "too many voters for the candidates";
+    return VoteType(0, 0);
+  }
+  const size_t ballots_size = BallotsSize(header);
+  const size_t weights_size = weighted ?
+                              4 * (static_cast<size_t>(header.num_ballots) +
+                                   header.num_voters) : 0;
+  if (size != sizeof(header) + ballots_size + weights_size) {
+    *error = "binary file size does not match its header";
+    return VoteType(0, 0);
+  }
+
+  const int num_candidates = header.num_candidates;
+  const int num_voters = header.num_voters;
+  const int num_ballots = header.num_ballots;
+  const size_t row_size = static_cast<size_t>(num_candidates) *
+                          header.id_width;
+  const char* ballots = data + sizeof(header);
+  // The sections are 4-byte aligned within the page-aligned mapping.
+  const uint32_t* counts = reinterpret_cast<const uint32_t*>(ballots +
+                                                             ballots_size);
+  const uint32_t* voter_ballots = counts + num_ballots;
+  VoteType vote(num_candidates, num_voters);
+  if (weighted) {
+    // The voters' ballot ids and the multiplicities are checked on the
+    // mapping, the vote then takes the sections as they are.
+    vector<uint32_t> multiplicities(num_ballots, 0);
+    for (int v = 0; v < num_voters; ++v) {
+      if (voter_ballots[v] >= header.num_ballots) {
+        *error = "ballot id out of range";
+        return VoteType(0, 0);
+      }
+      ++multiplicities[voter_ballots[v]];
+    }
+    for (int b = 0; b < num_ballots; ++b) {
+      if (multiplicities[b] != counts[b]) {
+        *error = "ballot multiplicities do not match the voters";
+        return VoteType(0, 0);
+      }
+    }
+    const bool valid = header.id_width == 1 ?
+        vote.AddDistinctBallots(reinterpret_cast<const uint8_t*>(ballots),
+                                num_ballots, counts, voter_ballots) :
+        vote.AddDistinctBallots(reinterpret_cast<const uint16_t*>(ballots),
+                                num_ballots, counts, voter_ballots);
+    if (!valid) {
+      *error = "ballot is not a permutation of the candidates";
+      return VoteType(0, 0);
+    }
+    return vote;
+  }
+  // Ballots of unweighted files may repeat, they are collapsed on insertion.
+  vector<int> row(num_candidates);
+  vector<int> seen(num_candidates, -1);
+  for (int b = 0; b < num_ballots; ++b) {
+    const char* ballot = ballots + b * row_size;
+    const bool valid = header.id_width == 1 ?
+                       ReadBallot<uint8_t>(ballot, b, &row, &seen) :
+                       ReadBallot<uint16_t>(ballot, b, &row, &seen);
+    if (!valid) {
+      *error = "ballot is not a permutation of the candidates";
+      return VoteType(0, 0);
+    }
+    vote.AddPreference(b, row);
+  }
+  return vote;
+}
+
+bool BinaryFormat::Write(const Vote& vote, const bool weighted,
+                         const string& path) {
+  const int num_candidates = vote.num_candidates();
+  const int num_voters = vote.num_voters();
+  const int num_ballots = weighted ? vote.num_ballots() : num_voters;
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_candidates = num_candidates;
+  header.num_voters = num_voters;
+  header.num_ballots = num_ballots;
+  header.id_width = num_candidates <= CompactVote::MaxCandidates() ? 1 : 2;
+  header.flags = weighted ? kWeighted : 0;
+
+  vector<char> ballots(BallotsSize(header), 0);
+  char* pos = ballots.data();
+  for (int b = 0; b < num_ballots; ++b) {
+    const Vote::Row pref = weighted ? vote.ballot(b) : vote.preference(b);
+    for (int c = 0; c < num_candidates; ++c) {
+      if (header.id_width == 1) {
+        *pos = static_cast<uint8_t>(pref[c]);
+      } else {
+        const uint16_t id = pref[c];
+        memcpy(pos, &id, sizeof(id));
+      }
+      pos += header.id_width;
+    }
+  }
+  ofstream stream(path.c_str(), std::ios::binary);
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.write(ballots.data(), ballots.size());
+  if (weighted) {
+    vector<uint32_t> counts(num_ballots);
+    for (int b = 0; b < num_ballots; ++b) {
+      counts[b] = vote.count(b);
+    }
+    vector<uint32_t> voter_ballots(num_voters);
+    for (int v = 0; v < num_voters; ++v) {
+      voter_ballots[v] = vote.voter_ballot(v);
+    }
+    stream.write(reinterpret_cast<const char*>(counts.data()),
+                 counts.size() * sizeof(uint32_t));
+    stream.write(reinterpret_cast<const char*>(voter_ballots.data()),
+                 voter_ballots.size() * sizeof(uint32_t));
+  }
+  return stream.good();
+}
+
+template Vote BinaryFormat::Read<Vote>(const char* data, const size_t size,
+                                       string* error);
+template CompactVote BinaryFormat::Read<CompactVote>(const char* data,
+                                                     const size_t size,
+                                                     string* error);
+
+}  // namespace bush
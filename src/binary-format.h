@@ -0,0 +1,68 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_BINARY_FORMAT_H_
+#define SRC_BINARY_FORMAT_H_
+
+#include <cstdint>
+#include <string>
+#include "./vote.h"
+
+namespace bush {
+
+// Compact binary vote format, stored in host byte order:
+//   header (32 bytes, see Header)
+//   num_ballots x num_candidates candidate ids of id_width bytes each,
+//   zero-padded to a multiple of 4 bytes
+//   if kWeighted is set:
+//     uint32 multiplicity per ballot
+//     uint32 ballot id per voter
+// Without kWeighted there is one ballot per voter in voter order.
+// The sections are 4-byte aligned and read directly from the mapping. The
+// distinct ballots, multiplicities and voters' ballot ids of weighted files
+// are taken into the vote as they are, only unweighted ballots are hashed to
+// collapse repeated ones.
+class BinaryFormat {
+ public:
+  static const char kMagic[4];
+  static const uint32_t kVersion = 1;
+  // Candidate ids are stored in one byte for up to
+  // CompactVote::MaxCandidates() candidates.
+
+  enum Flags {
+    // Distinct ballots with multiplicities and the voters' ballot ids.
+    kWeighted = 1
+  };
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_candidates;
+    uint32_t num_voters;
+    uint32_t num_ballots;
+    // Bytes per candidate id, 1 or 2.
+    uint32_t id_width;
+    uint32_t flags;
+    uint32_t reserved;
+  };
+
+  // Returns whether the data starts with the binary format magic.
+  static bool IsBinary(const char* data, const size_t size);
+
+  // Reads the binary vote from given memory. Returns an empty vote and sets
+  // the error message if the data is malformed or has more candidates than
+  // VoteType can represent. The ballots of weighted files are taken to be
+  // distinct, as written by Write.
+  template<class VoteType>
+  static VoteType Read(const char* data, const size_t size,
+                       std::string* error);
+
+  // Returns the number of candidates of the binary data.
+  static int NumCandidates(const char* data, const size_t size);
+
+  // Writes the vote in binary format to the file at given path, with distinct
+  // ballots and multiplicities if weighted. Returns false on failure.
+  static bool Write(const Vote& vote, const bool weighted,
+                    const std::string& path);
+};
+
+}  // namespace bush
+#endif  // SRC_BINARY_FORMAT_H_
@@ -0,0 +1,147 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_BUDGET_SCHEDULER_H_
+#define SRC_BUDGET_SCHEDULER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "./clock.h"
+#include "./deadline.h"
+#include "./thread-pool.h"
+
+namespace base {
+
+// Distributes a time budget over the anytime searches of weighted items in
+// rounds. The first round gives every item a short slice proportional to its
+// weight, which completes the searches of the easy items. Each further round
+// splits the remaining budget among the items still open, boosting those whose
+// last search improved. Searches restart on each round, so an item is only
+// searched again when its slice at least doubles. Items of weight 0 are
+// triaged out and not searched at all.
+class BudgetScheduler {
+ public:
+  // The first round spends 1/kFirstRoundFraction of the budget.
+  static const int kFirstRoundFraction = 8;
+  // Weight factor of the items whose last search improved.
+  static const int kImprovedBoost = 4;
+  static const int kMaxRounds = 8;
+
+  // Searches the item until it is completed or the deadline expires, returns
+  // whether its result improved.
+  typedef std::function<bool(const int item, Deadline* deadline)> Search;
+
+  // How the budget was spent, times in microseconds on the scheduler's clock,
+  // summed over all threads.
+  struct Report {
+    Report()
+        : budget(0),
+          spent(0),
+          num_items(0),
+          num_triaged(0),
+          num_completed(0),
+          num_rounds(0),
+          num_searches(0) {}
+
+    Clock::Diff budget;
+    Clock::Diff spent;
+    int num_items;
+    // Items not searched.
+    int num_triaged;
+    // Items whose search completed before its deadline.
+    int num_completed;
+    int num_rounds;
+    int num_searches;
+  };
+
+  // Initialises the scheduler with given budget in microseconds on the clock,
+  // the searches of a round run on the given number of threads.
+  BudgetScheduler(const Clock::Type clock_type, const Clock::Diff budget,
+                  const int num_threads)
+      : clock_type_(clock_type),
+        budget_(budget),
+        num_threads_(num_threads) {}
+
+  // Searches the items of positive weight within the budget and returns how
+  // it was spent. The searches of different items may run in parallel.
+  Report Run(const std::vector<int>& weights, const Search& search) const {
+    const int num_items = weights.size();
+    Report report;
+    report.budget = budget_;
+    report.num_items = num_items;
+    std::vector<int> open;
+    std::vector<int64_t> priorities(num_items, 0);
+    int64_t total_priority = 0;
+    for (int i = 0; i < num_items; ++i) {
+      if (weights[i] > 0) {
+        open.push_back(i);
+        priorities[i] = weights[i];
+        total_priority += weights[i];
+      }
+    }
+    report.num_triaged = num_items - open.size();
+    if (open.empty() || budget_ <= 0) {
+      return report;
+    }
+    std::vector<Clock::Diff> slices(num_items, 0);
+    std::vector<Clock::Diff> elapsed(num_items, 0);
+    std::vector<char> improved(num_items, false);
+    std::vector<char> completed(num_items, false);
+    double unit = static_cast<double>(budget_) /
+                  (kFirstRoundFraction * total_priority);
+    for (auto it = open.cbegin(), end = open.cend(); it != end; ++it) {
+      slices[*it] = unit * priorities[*it];
+    }
+    ThreadPool pool(num_threads_);
+    while (!open.empty() && report.num_rounds < kMaxRounds) {
+      pool.ParallelFor(0, open.size(), [&](const int j) {
+        const int i = open[j];
+        Deadline deadline(clock_type_, slices[i]);
+        improved[i] = search(i, &deadline);
+        completed[i] = !deadline.expired();
+        elapsed[i] = deadline.elapsed();
+      });
+      ++report.num_rounds;
+      report.num_searches += open.size();
+      // Close the completed items and reprioritise the others.
+      total_priority = 0;
+      size_t num_open = 0;
+      for (size_t j = 0; j < open.size(); ++j) {
+        const int i = open[j];
+        report.spent += elapsed[i];
+        if (completed[i]) {
+          ++report.num_completed;
+          continue;
+        }
+        priorities[i] = weights[i] * (improved[i] ? kImprovedBoost : 1);
+        total_priority += priorities[i];
+        open[num_open++] = i;
+      }
+      open.resize(num_open);
+      const Clock::Diff remaining = budget_ - report.spent;
+      if (open.empty() || remaining <= 0) {
+        break;
+      }
+      unit = static_cast<double>(remaining) / total_priority;
+      // A slice less than double the last one repeats mostly the same search.
+      num_open = 0;
+      for (size_t j = 0; j < open.size(); ++j) {
+        const int i = open[j];
+        const Clock::Diff slice = unit * priorities[i];
+        if (slice >= 2 * slices[i]) {
+          slices[i] = slice;
+          open[num_open++] = i;
+        }
+      }
+      open.resize(num_open);
+    }
+    return report;
+  }
+
+ private:
+  Clock::Type clock_type_;
+  Clock::Diff budget_;
+  int num_threads_;
+};
+
+}  // namespace base
+#endif  // SRC_BUDGET_SCHEDULER_H_
@@ -0,0 +1,97 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_BUFFERED_WRITER_H_
+#define SRC_BUFFERED_WRITER_H_
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace base {
+
+// Text writer collecting the output in a fixed-size buffer, which is written
+// to the stream in large blocks. Integers are formatted without streams.
+class BufferedWriter {
+ public:
+  static const size_t kBufferSize = 1 << 16;
+
+  explicit BufferedWriter(FILE* stream)
+      : stream_(stream),
+        size_(0),
+        buffer_(kBufferSize) {}
+
+  ~BufferedWriter() {
+    Flush();
+  }
+
+  void Write(const char* data, const size_t size) {
+    if (size_ + size > kBufferSize) {
+      Flush();
+      if (size > kBufferSize) {
+        fwrite(data, 1, size, stream_);
+        return;
+      }
+    }
+    memcpy(buffer_.data() + size_, data, size);
+    size_ += size;
+  }
+
+  void Write(const std::string& str) {
+    Write(str.data(), str.size());
+  }
+
+  void Write(const char c) {
+    if (size_ == kBufferSize) {
+      Flush();
+    }
+    buffer_[size_++] = c;
+  }
+
+  void Write(const int value) {
+    // Digits in reverse order, the sign and up to 10 digits.
+    char digits[11];
+    int num_digits = 0;
+    unsigned int rest = value < 0 ? -static_cast<unsigned int>(value) : value;
+    do {
+      digits[num_digits++] = '0' + rest % 10;
+      rest /= 10;
+    } while (rest);
+    if (value < 0) {
+      digits[num_digits++] = '-';
+    }
+    if (size_ + num_digits > kBufferSize) {
+      Flush();
+    }
+    while (num_digits) {
+      buffer_[size_++] = digits[--num_digits];
+    }
+  }
+
+  // Writes the values separated by spaces and a line break.
+  void WriteLine(const std::vector<int>& values) {
+    for (auto it = values.cbegin(), end = values.cend(); it != end; ++it) {
+      if (it != values.cbegin()) {
+        Write(' ');
+      }
+      Write(*it);
+    }
+    Write('\n');
+  }
+
+  // Writes the buffered output to the stream.
+  void Flush() {
+    if (size_) {
+      fwrite(buffer_.data(), 1, size_, stream_);
+      size_ = 0;
+    }
+    fflush(stream_);
+  }
+
+ private:
+  FILE* stream_;
+  size_t size_;
+  std::vector<char> buffer_;
+};
+
+}  // namespace base
+#endif  // SRC_BUFFERED_WRITER_H_
@@ -0,0 +1,295 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gflags/gflags.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "./clock.h"
+#include "./profile-generator.h"
+#include "./vote.h"
+#include "./voting-system.h"
+#include "./system-registry.h"
+#include "./stats.h"
+
+using std::cout;
+using std::max;
+using std::istringstream;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using base::Clock;
+using base::Stats;
+using bush::CompactVote;
+using bush::ProfileGenerator;
+using bush::VotingSystem;
+using bush::VotingSystems;
+
+// Command-line flag for the profile generators.
+DEFINE_string(generators, "ic,mallows,urn",
+              "Comma-separated profile generators (ic, mallows, urn)");
+
+// Command-line flag for the numbers of candidates.
+DEFINE_string(candidates, "4,8,16", "Comma-separated numbers of candidates");
+
+// Command-line flag for the numbers of voters.
+DEFINE_string(voters, "100,1000,10000", "Comma-separated numbers of voters");
+
+// Command-line flag for the Mallows dispersion.
+DEFINE_double(phi, 0.5, "Dispersion of the Mallows profiles in [0, 1]");
+
+// Command-line flag for the urn contagion.
+DEFINE_double(alpha, 0.1, "Contagion of the urn profiles, at least 0");
+
+// Command-line flag for the generator seed.
+DEFINE_int32(seed, 1, "Seed of the profile generators");
+
+// Command-line flag for the number of queries per benchmark.
+DEFINE_int32(queries, 5, "Number of selected voters per benchmark");
+
+// Command-line flag for the time limit of each query.
+DEFINE_double(timelimit, 0.1, "Time limit of each query in seconds");
+
+// Command-line flag for the number of threads.
+DEFINE_int32(threads, 1, "Number of threads used by the nixon and gandhi "
+                         "strategies");
+
+// The command-line usage text.
+const string kUsage =  // NOLINT
+  string("Usage:\n") +
+         "  $ bush-bench [flags]\n" +
+         "  Benchmarks every voting system and strategy on synthetic\n" +
+         "  profiles, one JSON object per line and benchmark";
+
+static const vector<string> kSystems = bush::VotingSystemNames();
+static const char* kStrategies[] = {"bush", "nixon", "gandhi"};
+static const VotingSystem::Strategy kStrategyTypes[] = {
+  VotingSystem::kSimple, VotingSystem::kComplete, VotingSystem::kIndependent
+};
+
+// Times of a benchmark in microseconds and the counters of its queries.
+struct Timing {
+  Clock::Diff generate;
+  Clock::Diff run;
+  uint64_t utility_calls;
+  uint64_t find_winner_calls;
+  uint64_t samples;
+};
+
+// Returns the comma-separated values.
+template<typename T>
+vector<T> Split(const string& list) {
+  vector<T> values;
+  istringstream stream(list);
+  string item;
+  while (getline(stream, item, ',')) {
+    istringstream item_stream(item);
+    T value;
+    if (item_stream >> value) {
+      values.push_back(value);
+    }
+  }
+  return values;
+}
+
+// Returns the generated profile.
+CompactVote Generate(const string& generator, const int num_candidates,
+                     const int num_voters) {
+  ProfileGenerator<CompactVote> gen(FLAGS_seed);
+  if (generator == "mallows") {
+    return gen.Mallows(num_candidates, num_voters, FLAGS_phi);
+  } else if (generator == "urn") {
+    return gen.Urn(num_candidates, num_voters, FLAGS_alpha);
+  }
+  return gen.ImpartialCulture(num_candidates, num_voters);
+}
+
+// Answers the queries on the system sharing its precomputation.
+template<class System>
+void Query(const CompactVote& vote, const VotingSystem::Strategy strategy,
+           const VotingSystem::Options& options) {
+  const System system(vote, strategy, options);
+  const int num_voters = vote.num_voters();
+  for (int q = 0; q < FLAGS_queries; ++q) {
+    system.StrategicPreference(
+        static_cast<int64_t>(q) * num_voters / FLAGS_queries);
+  }
+}
+
+// Visitor answering the queries on the visited system.
+struct QueryVisitor {
+  template<class System>
+  void Visit() {
+    Query<System>(*vote, strategy, *options);
+  }
+
+  const CompactVote* vote;
+  VotingSystem::Strategy strategy;
+  const VotingSystem::Options* options;
+};
+
+// Generates the profile and answers the queries, returns the times.
+Timing Run(const string& generator, const int num_candidates,
+           const int num_voters, const string& system,
+           const VotingSystem::Strategy strategy) {
+  Timing timing;
+  const Clock gen_beg(Clock::kRealMonotonic);
+  const CompactVote vote = Generate(generator, num_candidates, num_voters);
+  timing.generate = Clock(Clock::kRealMonotonic) - gen_beg;
+  VotingSystem::Options options;
+  options.num_threads = FLAGS_threads;
+  options.time_limit = FLAGS_timelimit * Clock::kMicroInSec;
+  const uint64_t utility_calls = Stats::count(Stats::kUtilityCalls);
+  const uint64_t find_winner_calls = Stats::count(Stats::kFindWinnerCalls);
+  const uint64_t samples = Stats::count(Stats::kSamples);
+  const Clock beg(Clock::kRealMonotonic);
+  QueryVisitor visitor = {&vote, strategy, &options};
+  VotingSystems<CompactVote>::Visit(system, &visitor);
+  timing.run = Clock(Clock::kRealMonotonic) - beg;
+  timing.utility_calls = Stats::count(Stats::kUtilityCalls) - utility_calls;
+  timing.find_winner_calls = Stats::count(Stats::kFindWinnerCalls) -
+                             find_winner_calls;
+  timing.samples = Stats::count(Stats::kSamples) - samples;
+  return timing;
+}
+
+// Runs the benchmark in a child process, which isolates its peak resident
+// set size. Returns false if the child failed.
+bool Benchmark(const string& generator, const int num_candidates,
+               const int num_voters, const int system, const int strategy) {
+  int fds[2];
+  if (pipe(fds)) {
+    return false;
+  }
+  const pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    const Timing timing = Run(generator, num_candidates, num_voters,
+                              kSystems[system], kStrategyTypes[strategy]);
+    const bool ok = write(fds[1], &timing, sizeof(timing)) == sizeof(timing);
+    _exit(ok ? 0 : 1);
+  }
+  close(fds[1]);
+  Timing timing;
+  const bool ok = pid > 0 &&
+                  read(fds[0], &timing, sizeof(timing)) == sizeof(timing);
+  close(fds[0]);
+  int status = 0;
+  rusage usage;
+  if (pid <= 0 || wait4(pid, &status, 0, &usage) != pid || !ok ||
+      !WIFEXITED(status) || WEXITSTATUS(status)) {
+    return false;
+  }
+  // The searches run until the time limit or convergence, so the query rate
+  // mostly reflects the time limit. The evaluation rate counts the winner
+  // determinations and the sample rate the gandhi samples, the work done
+  // within that time.
+  const double secs = timing.run * Clock::kSecInMicro;
+  const double queries_per_sec = secs > 0 ? FLAGS_queries / secs : 0.0;
+  char evals[64] = "null";
+  char samples[64] = "null";
+  if (Stats::kEnabled) {
+    snprintf(evals, sizeof(evals), "%.2f",
+             secs > 0 ? timing.find_winner_calls / secs : 0.0);
+    snprintf(samples, sizeof(samples), "%.2f",
+             secs > 0 ? timing.samples / secs : 0.0);
+  }
+  char line[640];
+  snprintf(line, sizeof(line),
+           "{\"generator\": \"%s\", \"candidates\": %d, \"voters\": %d, "
+           "\"system\": \"%s\", \"strategy\": \"%s\", \"queries\": %d, "
+           "\"generate_us\": %lld, \"wall_us\": %lld, "
+           "\"queries_per_sec\": %.2f, \"utility_calls\": %llu, "
+           "\"find_winner_calls\": %llu, \"evals_per_sec\": %s, "
+           "\"samples\": %llu, \"samples_per_sec\": %s, "
+           "\"peak_rss_kb\": %ld}\n",
+           generator.c_str(), num_candidates, num_voters,
+           kSystems[system].c_str(),
+           kStrategies[strategy], FLAGS_queries,
+           static_cast<long long>(timing.generate),  // NOLINT
+           static_cast<long long>(timing.run),  // NOLINT
+           queries_per_sec,
+           static_cast<unsigned long long>(timing.utility_calls),  // NOLINT
+           static_cast<unsigned long long>(timing.find_winner_calls),  // NOLINT
+           evals, static_cast<unsigned long long>(timing.samples),  // NOLINT
+           samples, usage.ru_maxrss);
+  cout << line << std::flush;
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  google::SetUsageMessage(kUsage);
+  // Parse command line flags and remove them from the argc and argv.
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  const vector<string> generators = Split<string>(FLAGS_generators);
+  const vector<int> candidates = Split<int>(FLAGS_candidates);
+  const vector<int> voters = Split<int>(FLAGS_voters);
+  if (argc != 1) {
+    cout << "Wrong argument number provided, use -help for help.\n"
+         << kUsage << "\n";
+    return 1;
+  } else if (FLAGS_phi < 0.0 || FLAGS_phi > 1.0) {
+    cout << "Invalid Mallows dispersion " << FLAGS_phi << ".\n";
+    return 1;
+  } else if (FLAGS_alpha < 0.0) {
+    cout << "Invalid urn contagion " << FLAGS_alpha << ".\n";
+    return 1;
+  } else if (FLAGS_queries < 1) {
+    cout << "Invalid number of queries " << FLAGS_queries << ".\n";
+    return 1;
+  } else if (!(FLAGS_timelimit >= 0)) {
+    cout << "Invalid time limit " << FLAGS_timelimit << ".\n";
+    return 1;
+  } else if (FLAGS_threads < 1) {
+    cout << "Invalid number of threads " << FLAGS_threads << ".\n";
+    return 1;
+  }
+  for (auto it = generators.cbegin(), end = generators.cend(); it != end;
+       ++it) {
+    if (*it != "ic" && *it != "mallows" && *it != "urn") {
+      cout << "Invalid generator " << *it << ".\n";
+      return 1;
+    }
+  }
+  int max_candidates = 2;
+  for (auto it = candidates.cbegin(), end = candidates.cend(); it != end;
+       ++it) {
+    if (*it < 2 || *it > CompactVote::MaxCandidates()) {
+      cout << "Invalid number of candidates " << *it << ".\n";
+      return 1;
+    }
+    max_candidates = max(max_candidates, *it);
+  }
+  for (auto it = voters.cbegin(), end = voters.cend(); it != end; ++it) {
+    if (*it < 1 || *it > CompactVote::MaxVoters(max_candidates)) {
+      cout << "Invalid number of voters " << *it << ".\n";
+      return 1;
+    }
+  }
+
+  int num_failed = 0;
+  for (auto gen = generators.cbegin(); gen != generators.cend(); ++gen) {
+    for (auto c = candidates.cbegin(); c != candidates.cend(); ++c) {
+      for (auto v = voters.cbegin(); v != voters.cend(); ++v) {
+        for (int system = 0, num_systems = kSystems.size();
+             system < num_systems; ++system) {
+          for (int strategy = 0; strategy < 3; ++strategy) {
+            if (!Benchmark(*gen, *c, *v, system, strategy)) {
+              std::cerr << "Benchmark " << *gen << " " << *c << " " << *v
+                        << " " << kSystems[system] << " "
+                        << kStrategies[strategy] << " failed.\n";
+              ++num_failed;
+            }
+          }
+        }
+      }
+    }
+  }
+  return num_failed ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gflags/gflags.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "./binary-format.h"
+#include "./mapped-file.h"
+#include "./parser.h"
+#include "./vote.h"
+
+using std::cout;
+using std::ofstream;
+using std::string;
+using base::MappedFile;
+using bush::BinaryFormat;
+using bush::Parser;
+using bush::Vote;
+
+// Command-line flag for the output format.
+DEFINE_string(format, "",
+              "Output format (text, binary), defaults to the format which "
+              "is not the input format");
+
+// Command-line flag for weighted binary output.
+DEFINE_bool(weighted, true,
+            "Store distinct ballots with multiplicities in binary output");
+
+// Command-line flag for the number of parsing threads.
+DEFINE_int32(threads, 1, "Number of threads used for parsing");
+
+// The command-line usage text.
+const string kUsage =  // NOLINT
+  string("Usage:\n") +
+         "  $ bush-convert <input> <output>\n" +
+         "  <input> is a preferences file in the text or binary vote format\n" +
+         "  <output> is the path of the converted preferences file";
+
+int main(int argc, char* argv[]) {
+  google::SetUsageMessage(kUsage);
+  // Parse command line flags and remove them from the argc and argv.
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  if (argc != 3) {
+    cout << "Wrong argument number provided, use -help for help.\n"
+         << kUsage << "\n";
+    return 1;
+  } else if (!Parser::FileSize(argv[1])) {
+    cout << "File " << argv[1] << " is empty or does not exist.\n";
+    return 1;
+  } else if (FLAGS_format != "" && FLAGS_format != "text" &&
+             FLAGS_format != "binary") {
+    cout << "Invalid output format " << FLAGS_format << ".\n";
+    return 1;
+  } else if (FLAGS_threads < 1) {
+    cout << "Invalid number of threads " << FLAGS_threads << ".\n";
+    return 1;
+  }
+
+  const string input_path = argv[1];
+  const string output_path = argv[2];
+  bool binary_input = false;
+  {
+    const MappedFile file(input_path);
+    binary_input = BinaryFormat::IsBinary(file.data(), file.size());
+  }
+  const bool binary_output = FLAGS_format.empty() ? !binary_input :
+                                                    FLAGS_format == "binary";
+  Parser parser(input_path, FLAGS_threads);
+  const Vote vote = parser.ParseVote<Vote>();
+  if (!parser.error().empty()) {
+    cout << "Malformed preferences " << parser.error() << ".\n";
+    return 1;
+  }
+
+  bool success = false;
+  if (binary_output) {
+    success = BinaryFormat::Write(vote, FLAGS_weighted, output_path);
+  } else {
+    ofstream stream(output_path.c_str());
+    stream << vote.str();
+    success = stream.good();
+  }
+  if (!success) {
+    cout << "Could not write " << output_path << ".\n";
+    return 1;
+  }
+  return 0;
+}
@@ -3,30 +3,59 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <cassert>
+#include <fstream>
 #include <iostream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <utility>
 #include <vector>
 #include "./clock.h"
+#include "./coalition.h"
+#include "./deadline.h"
 #include "./profiler.h"
 #include "./parser.h"
 #include "./vote.h"
 #include "./voting-system.h"
-#include "./plurality-system.h"
-#include "./borda-system.h"
 #include "./irv-system.h"
+#include "./system-registry.h"
+#include "./buffered-writer.h"
+#include "./stats.h"
+#include "./thread-pool.h"
+#include "./trace.h"
 
+using std::cerr;
+using std::cin;
 using std::cout;
 using std::endl;
+using std::function;
+using std::ifstream;
+using std::istream;
+using std::istringstream;
+using std::make_pair;
+using std::map;
+using std::pair;
+using std::shared_ptr;
 using std::string;
+using std::unique_ptr;
 using std::unordered_set;
 using std::unordered_map;
 using std::vector;
 using base::Clock;
+using base::Deadline;
 using base::Profiler;
+using base::BufferedWriter;
+using base::BudgetScheduler;
+using base::Stats;
+using base::ThreadPool;
+using base::Trace;
 using bush::Parser;
 using bush::Vote;
+using bush::CompactVote;
+using bush::Coalition;
 using bush::VotingSystem;
-using bush::Plurality;
-using bush::Borda;
+using bush::VotingSystems;
 using bush::Irv;
 
 #ifdef NIXON_STRATEGY_
@@ -40,6 +69,11 @@ static const char* kDefStrategy = "bush";
 // Command-line flag for the strategy of the strategic vote calculation.
 DEFINE_string(strategy, kDefStrategy, "Voting strategy (bush, nixon, gandhi)");
 
+// Command-line flag for the number of threads used for parsing and by the
+// nixon and gandhi strategies.
+DEFINE_int32(threads, 1, "Number of threads used for parsing and by the nixon "
+                         "and gandhi strategies");
+
 
 // Command-line flag for verbose output.
 DEFINE_bool(verbose, false, "Verbose output");
@@ -48,48 +82,188 @@ DEFINE_bool(verbose, false, "Verbose output");
 DEFINE_bool(brief, true, "Brief output, outputs only the strategic preference");
 
 // Command-line flag for execution time limit.
-DEFINE_int32(timelimit, 10, "Maximum execution time limit in seconds");
+DEFINE_double(timelimit, 10, "Maximum execution time limit in seconds");
+
+// Command-line flag for the clock measuring the time limit.
+DEFINE_string(timeclock, "cpu", "Clock measuring the time limit, cpu for the "
+                                "thread CPU time or wall for the wall-clock "
+                                "time");
+
+// Command-line flag for the batch mode query file.
+DEFINE_string(queries, "", "Batch mode, reads queries <voter id> <voting "
+                           "system> [<strategy>] line by line from given file "
+                           "or - for stdin");
+
+// Command-line flag for the exact IRV search.
+DEFINE_bool(exact, false, "Exact IRV search for the provably best preference, "
+                          "up to 64 candidates");
+
+// Command-line flag for the statistics report.
+DEFINE_bool(stats, false, "Outputs the instrumentation counters and phase "
+                          "times as JSON to stderr");
+
+// Command-line flag for the trace output.
+DEFINE_string(trace, "", "Writes the spans of parsing, preprocessing and "
+                         "searching as Chrome trace JSON to given file");
+
+// Command-line flag for the all voters mode.
+DEFINE_bool(all_voters, false, "Outputs the strategic preferences of all "
+                               "voters, one line per voter");
+
+// Command-line flag for the coalition mode.
+DEFINE_string(coalition, "", "Coalition mode, outputs the joint strategic "
+                             "preference of the comma-separated voter ids "
+                             "against the sincere other voters and the "
+                             "coalition's utility gain");
+
+// Command-line flag for the bloc coalition mode.
+DEFINE_bool(bloc, false, "Coalition mode for the bloc of all voters sharing "
+                         "the selected voter's ballot");
+
+// The names of the supported voting systems.
+static const vector<string> kVotingSystemNames = bush::VotingSystemNames();
+
+// Returns the comma-separated names of the supported voting systems.
+string VotingSystemList() {
+  string list;
+  for (auto it = kVotingSystemNames.cbegin(), end = kVotingSystemNames.cend();
+       it != end; ++it) {
+    if (it != kVotingSystemNames.cbegin()) {
+      list += ", ";
+    }
+    list += *it;
+  }
+  return list;
+}
 
 // The command-line usage text.
 const string kUsage =  // NOLINT
   string("Usage:\n") +
          "  $ bush <preferences> <voter id> <voting system>\n" +
+         "  $ bush --queries=<queries> <preferences>\n" +
+         "  $ bush --all_voters <preferences> <voting system>\n" +
+         "  $ bush --coalition=<voter ids> <preferences> <voting system>\n" +
+         "  $ bush --bloc <preferences> <voter id> <voting system>\n" +
          "  <preferences> is a preferences file in the vote format\n" +
          "  <voter id> is the index of the selected voter\n" +
-         "  <voting system> is one of these: plurality, irv, borda";
+         "  <voter ids> is a comma-separated list of voter indices\n" +
+         "  <voting system> is one of these:\n" +
+         "    " + VotingSystemList() + "\n" +
+         "  <queries> is a file of one query per line or - for stdin";
 
-int main(int argc, char* argv[]) {
-  google::SetUsageMessage(kUsage);
-  // Parse command line flags and remove them from the argc and argv.
-  google::ParseCommandLineFlags(&argc, &argv, true);
-  if (argc != 4) {
-    cout << "Wrong argument number provided, use -help for help.\n"
-         << kUsage << "\n";
-    return 1;
-  } else if (!Parser::FileSize(argv[1])) {
-    cout << "File " << argv[1] << " is empty or does not exist.\n";
-    return 1;
+// The supported voting systems and strategies.
+static const unordered_set<string> kVotingSystems(kVotingSystemNames.cbegin(),
+                                                  kVotingSystemNames.cend());
+static const unordered_map<string, VotingSystem::Strategy>
+  kStrategies({{"bush", VotingSystem::kSimple},
+               {"nixon", VotingSystem::kComplete},
+               {"gandhi", VotingSystem::kIndependent}});
+static const unordered_map<string, Clock::Type>
+  kTimeClocks({{"cpu", Clock::kThreadCpuTime},
+               {"wall", Clock::kRealMonotonic}});
+
+// Returns the options of the voting systems set by the command-line flags.
+VotingSystem::Options SystemOptions() {
+  VotingSystem::Options options;
+  options.num_threads = FLAGS_threads;
+  options.time_limit = FLAGS_timelimit * Clock::kMicroInSec;
+  options.clock_type = kTimeClocks.at(FLAGS_timeclock);
+  options.exact = FLAGS_exact;
+  return options;
+}
+
+// Returns the vote parsed as VoteType, the time is accounted to the parse
+// phase.
+template<class VoteType>
+VoteType ParseVote(Parser* parser) {
+  Stats::PhaseTimer timer(Stats::kParse);
+  Trace::Span span("parse");
+  return parser->ParseVote<VoteType>();
+}
+
+// Outputs the candidates' ratings of the scoring or pairwise system.
+template<class System>
+void WriteDetails(const System& system, const VotingSystem::Strategy) {
+  cout << "Ratings: ";
+  const vector<int>& ratings = system.base_ratings();
+  for (auto it = ratings.cbegin(), end = ratings.cend(); it != end; ++it) {
+    if (it != ratings.cbegin()) {
+      cout << " ";
+    }
+    cout << *it;
   }
+  cout << "\n";
+}
 
-  const string input_path = argv[1];
-  const int selected_voter_id = Parser::Convert<int>(argv[2]);
-  const string voting_system = argv[3];
-  Parser parser(input_path);
-  Vote vote = parser.ParseVote();
+// Outputs whether the IRV preference is proven to be optimal and how the nixon
+// precomputation spent its search budget.
+template<class VoteType>
+void WriteDetails(const Irv<VoteType>& system,
+                  const VotingSystem::Strategy strategy) {
+  cout << "Optimal: " << (system.optimal() ? "yes" : "no") << "\n";
+  if (strategy == VotingSystem::kComplete) {
+    const BudgetScheduler::Report& report = system.search_report();
+    cout << "Search budget: " << Clock::DiffStr(report.budget)
+         << ", spent " << Clock::DiffStr(report.spent) << " in "
+         << report.num_rounds << " rounds, " << report.num_searches
+         << " searches\n"
+         << "Searched ballots: "
+         << report.num_items - report.num_triaged << " of "
+         << report.num_items << ", completed " << report.num_completed
+         << "\n";
+  }
+}
 
-  unordered_set<string> voting_systems({"plurality", "irv", "borda"});
-  unordered_map<string, VotingSystem::Strategy>
-    strategies({{"bush", VotingSystem::kSimple},
-                {"nixon", VotingSystem::kComplete},
-                {"gandhi", VotingSystem::kIndependent}});
+// Outputs the strategic preference of the selected voter under the System,
+// preceded by the system's details in verbose mode.
+template<class System, class VoteType>
+void RunSystem(const VoteType& vote, const int selected_voter_id,
+               const VotingSystem::Strategy strategy) {
+  System system(vote, selected_voter_id, strategy, SystemOptions());
+  if (FLAGS_verbose) {
+    WriteDetails(system, strategy);
+  }
+  const vector<int>& strategic_pref = system.strategic_preference();
+  for (auto it = strategic_pref.cbegin(), end = strategic_pref.cend();
+       it != end; ++it) {
+    if (it != strategic_pref.cbegin()) {
+      cout << " ";
+    }
+    cout << *it;
+  }
+}
+
+// Visitor running the visited system for the selected voter.
+template<class VoteType>
+struct RunVisitor {
+  template<class System>
+  void Visit() {
+    RunSystem<System>(*vote, selected_voter_id, strategy);
+  }
+
+  const VoteType* vote;
+  int selected_voter_id;
+  VotingSystem::Strategy strategy;
+};
+
+// Computes and outputs the strategic preference of the selected voter, using
+// VoteType for the parsed preferences.
+template<class VoteType>
+int Run(Parser* parser, const string& input_path, const int selected_voter_id,
+        const string& voting_system) {
+  VoteType vote = ParseVote<VoteType>(parser);
+  if (!parser->error().empty()) {
+    cout << "Malformed preferences " << parser->error() << ".\n";
+    return 1;
+  }
 
   if (selected_voter_id >= vote.num_voters()) {
     cout << "Invalid selected voter id " << selected_voter_id << ".\n";
     return 1;
-  } else if (voting_systems.find(voting_system) == voting_systems.end()) {
+  } else if (kVotingSystems.find(voting_system) == kVotingSystems.end()) {
     cout << "Invalid voting system " << voting_system << ".\n";
     return 1;
-  } else if (strategies.find(FLAGS_strategy) == strategies.end()) {
+  } else if (kStrategies.find(FLAGS_strategy) == kStrategies.end()) {
     cout << "Invalid voting strategy " << FLAGS_strategy << ".\n";
     return 1;
   }
@@ -103,58 +277,90 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  const VotingSystem::Strategy strategy = strategies[FLAGS_strategy];
-  if (voting_system == "plurality") {
-    // Plurality voting system.
-    Plurality system(vote, selected_voter_id, strategy);
+  RunVisitor<VoteType> visitor = {&vote, selected_voter_id,
+                                  kStrategies.at(FLAGS_strategy)};
+  VotingSystems<VoteType>::Visit(voting_system, &visitor);
+  cout << endl;
+  return 0;
+}
 
-    if (FLAGS_verbose) {
-      cout << "Ratings: ";
-      const vector<int>& ratings = system.base_ratings();
-      for (auto it = ratings.cbegin(), end = ratings.cend();
-           it != end; ++it) {
-        if (it != ratings.cbegin()) {
-          cout << " ";
-        }
-        cout << *it;
-      }
-      cout << "\n";
+// A query answering the strategic preference of the selected voter.
+typedef function<vector<int>(int)> Query;
+
+// Visitor creating the visited system of the vote for the strategy, which
+// answers the query.
+template<class VoteType>
+struct QueryVisitor {
+  template<class System>
+  void Visit() {
+    const shared_ptr<const System> system(
+        new System(*vote, strategy, SystemOptions()));
+    *query = [system](const int selected_voter_id) {
+      return system->StrategicPreference(selected_voter_id);
+    };
+  }
+
+  const VoteType* vote;
+  VotingSystem::Strategy strategy;
+  Query* query;
+};
+
+// Answers the queries read from given path, one output line per query line.
+// The precomputation of each voting system and strategy is shared across the
+// queries, using VoteType for the parsed preferences.
+template<class VoteType>
+int RunQueries(Parser* parser, const string& query_path) {
+  VoteType vote = ParseVote<VoteType>(parser);
+  if (!parser->error().empty()) {
+    cout << "Malformed preferences " << parser->error() << ".\n";
+    return 1;
+  }
+  ifstream query_file;
+  istream* queries = &cin;
+  if (query_path != "-") {
+    query_file.open(query_path.c_str());
+    if (!query_file.good()) {
+      cout << "File " << query_path << " does not exist.\n";
+      return 1;
     }
-    const vector<int>& strategic_pref = system.strategic_preference();
-    for (auto it = strategic_pref.cbegin(), end = strategic_pref.cend();
-         it != end; ++it) {
-      if (it != strategic_pref.cbegin()) {
-        cout << " ";
+    queries = &query_file;
+  }
+
+  // The queries of each voting system and strategy, created on first use.
+  map<pair<string, VotingSystem::Strategy>, Query> systems;
+  string line;
+  while (getline(*queries, line)) {
+    istringstream query(line);
+    int selected_voter_id = 0;
+    string voting_system;
+    string strategy_name = FLAGS_strategy;
+    if (!(query >> selected_voter_id)) {
+      if (query.eof()) {
+        // Skip empty lines.
+        continue;
       }
-      cout << *it;
+      cout << "Malformed query " << line << ".\n";
+      continue;
     }
-  } else if (voting_system == "borda") {
-    // Borda count voting system.
-    Borda system(vote, selected_voter_id, strategy);
-    if (FLAGS_verbose) {
-      cout << "Ratings: ";
-      const vector<int>& ratings = system.base_ratings();
-      for (auto it = ratings.cbegin(), end = ratings.cend();
-           it != end; ++it) {
-        if (it != ratings.cbegin()) {
-          cout << " ";
-        }
-        cout << *it;
-      }
-      cout << "\n";
+    query >> voting_system >> strategy_name;
+    if (selected_voter_id < 0 || selected_voter_id >= vote.num_voters()) {
+      cout << "Invalid selected voter id " << selected_voter_id << ".\n";
+      continue;
+    } else if (kVotingSystems.find(voting_system) == kVotingSystems.end()) {
+      cout << "Invalid voting system " << voting_system << ".\n";
+      continue;
+    } else if (kStrategies.find(strategy_name) == kStrategies.end()) {
+      cout << "Invalid voting strategy " << strategy_name << ".\n";
+      continue;
     }
-    const vector<int>& strategic_pref = system.strategic_preference();
-    for (auto it = strategic_pref.cbegin(), end = strategic_pref.cend();
-         it != end; ++it) {
-      if (it != strategic_pref.cbegin()) {
-        cout << " ";
-      }
-      cout << *it;
+
+    const VotingSystem::Strategy strategy = kStrategies.at(strategy_name);
+    Query& system = systems[make_pair(voting_system, strategy)];
+    if (!system) {
+      QueryVisitor<VoteType> visitor = {&vote, strategy, &system};
+      VotingSystems<VoteType>::Visit(voting_system, &visitor);
     }
-  } else if (voting_system == "irv") {
-    // Instant-runoff voting system.
-    Irv system(vote, selected_voter_id, strategy);
-    const vector<int>& strategic_pref = system.strategic_preference();
+    const vector<int> strategic_pref = system(selected_voter_id);
     for (auto it = strategic_pref.cbegin(), end = strategic_pref.cend();
          it != end; ++it) {
       if (it != strategic_pref.cbegin()) {
@@ -162,7 +368,268 @@ int main(int argc, char* argv[]) {
       }
       cout << *it;
     }
+    cout << "\n";
   }
-  cout << endl;
+  cout.flush();
+  return 0;
+}
+
+// Writes the strategic preference of every voter, one line per voter. Voters
+// sharing a ballot share their strategic preference, which is computed once
+// per ballot on all threads. The sampled gandhi preferences are computed per
+// voter, the sampler uses the threads itself.
+template<class System, class VoteType>
+void WriteAllVoters(const VoteType& vote,
+                    const VotingSystem::Strategy strategy,
+                    BufferedWriter* writer) {
+  const unique_ptr<const System> system(
+      new System(vote, strategy, SystemOptions()));
+  const int num_voters = vote.num_voters();
+  if (strategy == VotingSystem::kIndependent) {
+    for (int v = 0; v < num_voters; ++v) {
+      writer->WriteLine(system->StrategicPreference(v));
+    }
+    return;
+  }
+  const int num_ballots = vote.num_ballots();
+  vector<int> ballot_voters(num_ballots, -1);
+  for (int v = num_voters - 1; v >= 0; --v) {
+    ballot_voters[vote.voter_ballot(v)] = v;
+  }
+  vector<vector<int> > ballot_prefs(num_ballots);
+  ThreadPool pool(FLAGS_threads);
+  pool.ParallelFor(0, num_ballots, [&](const int b) {
+    if (ballot_voters[b] != -1) {
+      ballot_prefs[b] = system->StrategicPreference(ballot_voters[b]);
+    }
+  });
+  for (int v = 0; v < num_voters; ++v) {
+    writer->WriteLine(ballot_prefs[vote.voter_ballot(v)]);
+  }
+}
+
+// Visitor writing the strategic preferences of all voters under the visited
+// system.
+template<class VoteType>
+struct AllVotersVisitor {
+  template<class System>
+  void Visit() {
+    WriteAllVoters<System>(*vote, strategy, writer);
+  }
+
+  const VoteType* vote;
+  VotingSystem::Strategy strategy;
+  BufferedWriter* writer;
+};
+
+// Outputs the strategic preferences of all voters for given voting system,
+// using VoteType for the parsed preferences.
+template<class VoteType>
+int RunAllVoters(Parser* parser, const string& voting_system) {
+  VoteType vote = ParseVote<VoteType>(parser);
+  if (!parser->error().empty()) {
+    cout << "Malformed preferences " << parser->error() << ".\n";
+    return 1;
+  } else if (kVotingSystems.find(voting_system) == kVotingSystems.end()) {
+    cout << "Invalid voting system " << voting_system << ".\n";
+    return 1;
+  } else if (kStrategies.find(FLAGS_strategy) == kStrategies.end()) {
+    cout << "Invalid voting strategy " << FLAGS_strategy << ".\n";
+    return 1;
+  }
+
+  BufferedWriter writer(stdout);
+  AllVotersVisitor<VoteType> visitor = {&vote, kStrategies.at(FLAGS_strategy),
+                                        &writer};
+  VotingSystems<VoteType>::Visit(voting_system, &visitor);
   return 0;
 }
+
+// Returns the voter ids of the comma-separated list, an empty list if it is
+// malformed.
+vector<int> SplitVoterIds(const string& list) {
+  vector<int> voter_ids;
+  istringstream list_stream(list);
+  string item;
+  while (getline(list_stream, item, ',')) {
+    istringstream item_stream(item);
+    int voter_id = 0;
+    if (!(item_stream >> voter_id) || !(item_stream >> std::ws).eof()) {
+      return vector<int>();
+    }
+    voter_ids.push_back(voter_id);
+  }
+  return voter_ids;
+}
+
+// Visitor computing the joint strategic preference of the coalition under the
+// visited system.
+template<class VoteType>
+struct CoalitionVisitor {
+  template<class System>
+  void Visit() {
+    *joint_pref = System::CoalitionPreference(*coalition, deadline,
+                                              sincere_winner, winner);
+  }
+
+  const Coalition<VoteType>* coalition;
+  Deadline* deadline;
+  int* sincere_winner;
+  int* winner;
+  vector<int>* joint_pref;
+};
+
+// Outputs the joint strategic preference of the coalition of given voters, or
+// of the bloc of the first voter, under the voting system and the coalition's
+// utility gain, using VoteType for the parsed preferences. Outputs no joint
+// manipulation instead of a preference if the coalition stays sincere.
+template<class VoteType>
+int RunCoalition(Parser* parser, const string& input_path,
+                 const vector<int>& voter_ids, const string& voting_system) {
+  VoteType vote = ParseVote<VoteType>(parser);
+  if (!parser->error().empty()) {
+    cout << "Malformed preferences " << parser->error() << ".\n";
+    return 1;
+  }
+  for (auto it = voter_ids.cbegin(), end = voter_ids.cend(); it != end;
+       ++it) {
+    if (*it < 0 || *it >= vote.num_voters()) {
+      cout << "Invalid coalition voter id " << *it << ".\n";
+      return 1;
+    }
+  }
+  if (kVotingSystems.find(voting_system) == kVotingSystems.end()) {
+    cout << "Invalid voting system " << voting_system << ".\n";
+    return 1;
+  }
+
+  const Coalition<VoteType> coalition = FLAGS_bloc ?
+      Coalition<VoteType>::Bloc(vote, voter_ids[0]) :
+      Coalition<VoteType>(vote, voter_ids);
+  if (!FLAGS_brief || FLAGS_verbose) {
+    cout << "File: " << input_path << "\n"
+         << "Coalition: " << coalition.size() << " voters, "
+         << coalition.ballots().size() << " ballots\n"
+         << "Voting system: " << voting_system << "\n";
+    if (FLAGS_verbose) {
+      cout << "Vote input:\n" << vote.str() << "\n";
+    }
+  }
+
+  Stats::PhaseTimer timer(Stats::kSearch);
+  const VotingSystem::Options options = SystemOptions();
+  Deadline deadline(options.clock_type, options.time_limit);
+  int sincere_winner = 0;
+  int winner = 0;
+  vector<int> joint_pref;
+  CoalitionVisitor<VoteType> visitor = {&coalition, &deadline, &sincere_winner,
+                                        &winner, &joint_pref};
+  VotingSystems<VoteType>::Visit(voting_system, &visitor);
+  if (FLAGS_verbose) {
+    cout << "Winner: " << sincere_winner << " -> " << winner << "\n"
+         << "Utility: " << coalition.utility(sincere_winner) << " -> "
+         << coalition.utility(winner) << "\n";
+  }
+  if (joint_pref.empty()) {
+    // The coalition's voters keep their sincere ballots.
+    cout << "No joint manipulation";
+  }
+  for (auto it = joint_pref.cbegin(), end = joint_pref.cend(); it != end;
+       ++it) {
+    if (it != joint_pref.cbegin()) {
+      cout << " ";
+    }
+    cout << *it;
+  }
+  cout << "\nUtility gain: "
+       << coalition.utility(winner) - coalition.utility(sincere_winner)
+       << endl;
+  return 0;
+}
+
+// Runs the mode selected by the command-line flags on the validated
+// arguments.
+int Dispatch(char* argv[]) {
+  const string input_path = argv[1];
+  if (!FLAGS_queries.empty()) {
+    Parser parser(input_path, FLAGS_threads);
+    if (parser.NumCandidates() <= CompactVote::MaxCandidates()) {
+      return RunQueries<CompactVote>(&parser, FLAGS_queries);
+    }
+    return RunQueries<Vote>(&parser, FLAGS_queries);
+  } else if (FLAGS_all_voters) {
+    Parser parser(input_path, FLAGS_threads);
+    if (parser.NumCandidates() <= CompactVote::MaxCandidates()) {
+      return RunAllVoters<CompactVote>(&parser, argv[2]);
+    }
+    return RunAllVoters<Vote>(&parser, argv[2]);
+  } else if (!FLAGS_coalition.empty()) {
+    const vector<int> voter_ids = SplitVoterIds(FLAGS_coalition);
+    if (voter_ids.empty()) {
+      cout << "Invalid coalition " << FLAGS_coalition << ".\n";
+      return 1;
+    }
+    Parser parser(input_path, FLAGS_threads);
+    if (parser.NumCandidates() <= CompactVote::MaxCandidates()) {
+      return RunCoalition<CompactVote>(&parser, input_path, voter_ids,
+                                       argv[2]);
+    }
+    return RunCoalition<Vote>(&parser, input_path, voter_ids, argv[2]);
+  }
+  const int selected_voter_id = Parser::Convert<int>(argv[2]);
+  const string voting_system = argv[3];
+  Parser parser(input_path, FLAGS_threads);
+  if (FLAGS_bloc) {
+    const vector<int> voter_ids(1, selected_voter_id);
+    if (parser.NumCandidates() <= CompactVote::MaxCandidates()) {
+      return RunCoalition<CompactVote>(&parser, input_path, voter_ids,
+                                       voting_system);
+    }
+    return RunCoalition<Vote>(&parser, input_path, voter_ids, voting_system);
+  }
+  // Narrow candidate ids keep the ballots compact for up to
+  // CompactVote::MaxCandidates() candidates.
+  if (parser.NumCandidates() <= CompactVote::MaxCandidates()) {
+    return Run<CompactVote>(&parser, input_path, selected_voter_id,
+                            voting_system);
+  }
+  return Run<Vote>(&parser, input_path, selected_voter_id, voting_system);
+}
+
+int main(int argc, char* argv[]) {
+  google::SetUsageMessage(kUsage);
+  // Parse command line flags and remove them from the argc and argv.
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  const bool batch = !FLAGS_queries.empty();
+  const bool coalition = !FLAGS_coalition.empty();
+  if (argc != (batch ? 2 : FLAGS_all_voters || coalition ? 3 : 4)) {
+    cout << "Wrong argument number provided, use -help for help.\n"
+         << kUsage << "\n";
+    return 1;
+  } else if (!Parser::FileSize(argv[1])) {
+    cout << "File " << argv[1] << " is empty or does not exist.\n";
+    return 1;
+  } else if (FLAGS_threads < 1) {
+    cout << "Invalid number of threads " << FLAGS_threads << ".\n";
+    return 1;
+  } else if (!(FLAGS_timelimit >= 0)) {
+    cout << "Invalid time limit " << FLAGS_timelimit << ".\n";
+    return 1;
+  } else if (kTimeClocks.find(FLAGS_timeclock) == kTimeClocks.end()) {
+    cout << "Invalid time clock " << FLAGS_timeclock << ".\n";
+    return 1;
+  }
+
+  if (!FLAGS_trace.empty()) {
+    Trace::Enable();
+  }
+  const int status = Dispatch(argv);
+  if (FLAGS_stats) {
+    cerr << Stats::Json() << endl;
+  }
+  if (!FLAGS_trace.empty() && !Trace::Dump(FLAGS_trace)) {
+    cout << "Invalid trace file " << FLAGS_trace << ".\n";
+    return 1;
+  }
+  return status;
+}
@@ -0,0 +1,143 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./coalition.h"
+#include <cassert>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "./vote.h"
+
+using std::vector;
+using std::pair;
+using std::make_pair;
+using std::sort;
+using std::unique;
+
+namespace bush {
+
+// Returns the candidates of the (negated utility, candidate id) pairs by
+// decreasing utility, the lowest id on ties.
+static vector<int> ByUtility(vector<pair<int, int> >* utilities) {
+  sort(utilities->begin(), utilities->end());
+  vector<int> candidates;
+  candidates.reserve(utilities->size());
+  for (auto it = utilities->cbegin(), end = utilities->cend(); it != end;
+       ++it) {
+    candidates.push_back(it->second);
+  }
+  return candidates;
+}
+
+template<class VoteType>
+Coalition<VoteType> Coalition<VoteType>::Bloc(const VoteType& vote,
+                                              const int selected_voter) {
+  const int ballot = vote.voter_ballot(selected_voter);
+  const int num_voters = vote.num_voters();
+  vector<int> voters;
+  voters.reserve(vote.count(ballot));
+  for (int v = 0; v < num_voters; ++v) {
+    if (vote.voter_ballot(v) == ballot) {
+      voters.push_back(v);
+    }
+  }
+  return Coalition(vote, voters);
+}
+
+template<class VoteType>
+Coalition<VoteType>::Coalition(const VoteType& vote,
+                               const vector<int>& voters)
+    : vote_(vote),
+      utilities_(vote.num_candidates(), 0),
+      size_(0) {
+  vector<int> unique_voters = voters;
+  sort(unique_voters.begin(), unique_voters.end());
+  unique_voters.erase(unique(unique_voters.begin(), unique_voters.end()),
+                      unique_voters.end());
+  size_ = unique_voters.size();
+  vector<int> voter_ballots;
+  voter_ballots.reserve(size_);
+  for (auto it = unique_voters.cbegin(), end = unique_voters.cend();
+       it != end; ++it) {
+    assert(*it >= 0 && *it < vote.num_voters());
+    voter_ballots.push_back(vote.voter_ballot(*it));
+  }
+  sort(voter_ballots.begin(), voter_ballots.end());
+  for (auto it = voter_ballots.cbegin(), end = voter_ballots.cend();
+       it != end; ++it) {
+    if (ballots_.empty() || ballots_.back() != *it) {
+      ballots_.push_back(*it);
+      weights_.push_back(0);
+    }
+    ++weights_.back();
+  }
+  const int num_candidates = vote.num_candidates();
+  const int num_ballots = ballots_.size();
+  for (int i = 0; i < num_ballots; ++i) {
+    const typename VoteType::RatingRow ratings =
+        vote.ballot_ratings(ballots_[i]);
+    for (int c = 0; c < num_candidates; ++c) {
+      utilities_[c] += weights_[i] * ratings[c];
+    }
+  }
+}
+
+template<class VoteType>
+vector<int> Coalition<VoteType>::Targets(const int winner) const {
+  const int num_candidates = vote_.num_candidates();
+  vector<pair<int, int> > targets;
+  for (int c = 0; c < num_candidates; ++c) {
+    if (utilities_[c] <= utilities_[winner]) {
+      continue;
+    }
+    bool shared = true;
+    for (auto it = ballots_.cbegin(), end = ballots_.cend();
+         shared && it != end; ++it) {
+      const typename VoteType::RatingRow ratings = vote_.ballot_ratings(*it);
+      shared = ratings[c] >= ratings[winner];
+    }
+    if (shared) {
+      targets.push_back(make_pair(-utilities_[c], c));
+    }
+  }
+  return ByUtility(&targets);
+}
+
+template<class VoteType>
+vector<int> Coalition<VoteType>::Ranking() const {
+  const int num_candidates = vote_.num_candidates();
+  vector<pair<int, int> > ranking;
+  ranking.reserve(num_candidates);
+  for (int c = 0; c < num_candidates; ++c) {
+    ranking.push_back(make_pair(-utilities_[c], c));
+  }
+  return ByUtility(&ranking);
+}
+
+template<class VoteType>
+int Coalition<VoteType>::utility(const int candidate) const {
+  return utilities_[candidate];
+}
+
+template<class VoteType>
+const vector<int>& Coalition<VoteType>::ballots() const {
+  return ballots_;
+}
+
+template<class VoteType>
+const vector<int>& Coalition<VoteType>::weights() const {
+  return weights_;
+}
+
+template<class VoteType>
+int Coalition<VoteType>::size() const {
+  return size_;
+}
+
+template<class VoteType>
+const VoteType& Coalition<VoteType>::vote() const {
+  return vote_;
+}
+
+template class Coalition<Vote>;
+template class Coalition<CompactVote>;
+
+}  // namespace bush
@@ -0,0 +1,48 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_COALITION_H_
+#define SRC_COALITION_H_
+
+#include <vector>
+
+namespace bush {
+
+// Group of voters casting one joint ballot. The voters are grouped by their
+// sincere ballots with the number of coalition voters per ballot, so the
+// voting systems remove the coalition from their tallies once per ballot and
+// count the joint ballot once, weighted by the coalition size. The coalition
+// only moves for targets it shares: candidates every voter rates at least as
+// high as the sincere winner and the coalition in total higher.
+template<class VoteType>
+class Coalition {
+ public:
+  // Returns the bloc of all voters sharing the selected voter's ballot.
+  static Coalition Bloc(const VoteType& vote, const int selected_voter);
+
+  // Initialises the coalition of the given voters, duplicates count once.
+  Coalition(const VoteType& vote, const std::vector<int>& voters);
+  // Returns the targets shared against the given winner, by decreasing
+  // utility, the lowest id on ties.
+  std::vector<int> Targets(const int winner) const;
+  // Returns the candidates by decreasing utility, the lowest id on ties. It is
+  // the sincere preference of a bloc, but of no voter of a mixed coalition.
+  std::vector<int> Ranking() const;
+  // Returns the coalition's utility of the candidate winning, the sum of its
+  // voters' ratings of the candidate.
+  int utility(const int candidate) const;
+  // Returns the distinct sincere ballots of the coalition voters.
+  const std::vector<int>& ballots() const;
+  // Returns the number of coalition voters per ballot.
+  const std::vector<int>& weights() const;
+  int size() const;
+  const VoteType& vote() const;
+
+ private:
+  const VoteType& vote_;
+  std::vector<int> ballots_;
+  std::vector<int> weights_;
+  std::vector<int> utilities_;
+  int size_;
+};
+
+}  // namespace bush
+#endif  // SRC_COALITION_H_
@@ -0,0 +1,97 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_DEADLINE_H_
+#define SRC_DEADLINE_H_
+
+#include <algorithm>
+#include "./clock.h"
+
+namespace base {
+
+// Time budget of a search loop, measured on a wall-clock or CPU clock from
+// construction on. Reading the clock costs about as much as a cheap loop
+// iteration, so Expired reads it only every stride calls. The stride adapts
+// to the duration of the iterations, the clock is read about once per check
+// interval and the budget is overrun by at most about one interval.
+class Deadline {
+ public:
+  // Bounds of the check interval in microseconds, it is a fraction of the
+  // budget in between.
+  static const Clock::Diff kMinCheckInterval = 10;
+  static const Clock::Diff kMaxCheckInterval = 1000;
+  static const int kCheckFraction = 256;
+  static const int kMaxStride = 1 << 16;
+
+  // Initialises the deadline with given budget in microseconds on the clock.
+  Deadline(const Clock::Type type, const Clock::Diff budget)
+      : type_(type),
+        beg_(type),
+        budget_(budget),
+        interval_(CheckInterval(budget)),
+        stride_(1),
+        countdown_(1),
+        last_check_(0),
+        expired_(budget <= 0) {}
+
+  // Returns whether the budget is used up, reading the clock only every
+  // stride calls. Once expired, it stays expired.
+  bool Expired() {
+    if (expired_ || --countdown_) {
+      return expired_;
+    }
+    const Clock::Diff elapsed = Clock(type_) - beg_;
+    const Clock::Diff since_check = elapsed - last_check_;
+    last_check_ = elapsed;
+    if (elapsed >= budget_) {
+      expired_ = true;
+      return true;
+    }
+    // Aim at one clock read per interval, without passing the deadline by
+    // more than an interval.
+    if (since_check < interval_ / 2 && stride_ < kMaxStride) {
+      stride_ *= 2;
+    } else if (since_check > 2 * interval_ && stride_ > 1) {
+      stride_ /= 2;
+    }
+    if (since_check > 0 && budget_ - elapsed < since_check) {
+      stride_ = std::max<Clock::Diff>(1, stride_ * (budget_ - elapsed) /
+                                         since_check);
+    }
+    countdown_ = stride_;
+    return false;
+  }
+
+  // Returns whether Expired has reported the budget used up, without reading
+  // the clock.
+  bool expired() const {
+    return expired_;
+  }
+
+  // Returns the time spent since construction in microseconds.
+  Clock::Diff elapsed() const {
+    return Clock(type_) - beg_;
+  }
+
+ private:
+  // Returns the check interval for given budget.
+  static Clock::Diff CheckInterval(const Clock::Diff budget) {
+    const Clock::Diff interval = budget / kCheckFraction;
+    if (interval < kMinCheckInterval) {
+      return kMinCheckInterval;
+    } else if (interval > kMaxCheckInterval) {
+      return kMaxCheckInterval;
+    }
+    return interval;
+  }
+
+  Clock::Type type_;
+  Clock beg_;
+  Clock::Diff budget_;
+  Clock::Diff interval_;
+  int stride_;
+  int countdown_;
+  Clock::Diff last_check_;
+  bool expired_;
+};
+
+}  // namespace base
+#endif  // SRC_DEADLINE_H_
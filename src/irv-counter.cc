@@ -0,0 +1,239 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./irv-counter.h"
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include "./stats.h"
+#include "./vote.h"
+
+using std::vector;
+using std::copy;
+using std::fill;
+using std::min;
+using std::max;
+using std::numeric_limits;
+using base::Stats;
+
+namespace bush {
+
+template<class VoteType>
+const int IrvCounter<VoteType>::kInvalidId;
+
+template<class VoteType>
+IrvCounter<VoteType>::IrvCounter(const VoteType& vote)
+    : vote_(vote),
+      trie_(vote),
+      num_candidates_(vote.num_candidates()),
+      single_rows_(num_candidates_),
+      cursors_(trie_.num_nodes(), 0),
+      next_(trie_.num_nodes(), kInvalidId),
+      buckets_(num_candidates_, kInvalidId),
+      tallies_(num_candidates_, 0),
+      active_((num_candidates_ + 63) / 64, 0) {
+  singles_.reserve(2);
+}
+
+template<class VoteType>
+int IrvCounter<VoteType>::FindWinner(const int selected_voter,
+                                     const vector<int>& preference) {
+  Stats::Count(Stats::kFindWinnerCalls);
+  SingleOut(selected_voter, preference);
+  return Count<false>(nullptr);
+}
+
+template<class VoteType>
+int IrvCounter<VoteType>::FindWinner(const Coalition<VoteType>& coalition,
+                                     const vector<int>& preference) {
+  assert(static_cast<int>(preference.size()) == num_candidates_);
+  Stats::Count(Stats::kFindWinnerCalls);
+  const vector<int>& ballots = coalition.ballots();
+  const vector<int>& weights = coalition.weights();
+  const int num_ballots = ballots.size();
+  // The rows are copied before the singles point into them.
+  single_rows_.resize(num_ballots * num_candidates_);
+  singles_.clear();
+  for (int i = 0; i < num_ballots; ++i) {
+    const typename VoteType::Row ballot = vote_.ballot(ballots[i]);
+    int* row = single_rows_.data() + i * num_candidates_;
+    copy(ballot.begin(), ballot.end(), row);
+    singles_.push_back({row, -weights[i], 0});
+  }
+  singles_.push_back({preference.data(), coalition.size(), 0});
+  return Count<false>(nullptr);
+}
+
+template<class VoteType>
+int IrvCounter<VoteType>::Margin(const int selected_voter,
+                                 const vector<int>& preference) {
+  int margin = numeric_limits<int>::max();
+  SingleOut(selected_voter, preference);
+  Count<true>(&margin);
+  return margin;
+}
+
+template<class VoteType>
+void IrvCounter<VoteType>::SingleOut(const int selected_voter,
+                                     const vector<int>& preference) {
+  assert(static_cast<int>(preference.size()) == num_candidates_);
+  const typename VoteType::Row sincere = vote_.preference(selected_voter);
+  copy(sincere.begin(), sincere.end(), single_rows_.begin());
+  singles_.clear();
+  singles_.push_back({single_rows_.data(), -1, 0});
+  singles_.push_back({preference.data(), 1, 0});
+}
+
+template<class VoteType>
+template<bool kMargin>
+int IrvCounter<VoteType>::Count(int* margin) {
+  fill(buckets_.begin(), buckets_.end(), kInvalidId);
+  fill(tallies_.begin(), tallies_.end(), 0);
+  fill(active_.begin(), active_.end(), 0);
+  for (int c = 0; c < num_candidates_; ++c) {
+    active_[c >> 6] |= uint64_t(1) << (c & 63);
+  }
+  const int root = BallotTrie<VoteType>::kRoot;
+  for (int node = trie_.first_child(root), end = trie_.end(root); node < end;
+       node = trie_.end(node)) {
+    Transfer(node);
+  }
+  for (auto it = singles_.begin(), end = singles_.end(); it != end; ++it) {
+    Transfer(&*it);
+  }
+
+  const int plurality = vote_.num_voters() / 2;
+  int num_active = num_candidates_;
+  while (num_active) {
+    Stats::Count(Stats::kIrvRounds);
+    int min_rating = numeric_limits<int>::max();
+    int min_candidate = kInvalidId;
+    int max_rating = 0;
+    for (int c = 0; c < num_candidates_; ++c) {
+      if (!active(c)) {
+        continue;
+      }
+      const int rating = tallies_[c];
+      if (rating > plurality) {
+        // Winner found.
+        if (kMargin) {
+          *margin = min(*margin, rating - plurality);
+        }
+        return c;
+      }
+      if (rating < min_rating) {
+        min_rating = rating;
+        min_candidate = c;
+      }
+      if (kMargin) {
+        max_rating = max(max_rating, rating);
+      }
+    }
+    assert(min_candidate != kInvalidId);
+    if (kMargin) {
+      // Voters moving to the leader make it the winner, voters moving from
+      // another candidate to the eliminated one save it. The eliminated
+      // candidate is the lowest id on ties.
+      *margin = min(*margin, plurality + 1 - max_rating);
+      for (int c = 0; c < num_candidates_; ++c) {
+        if (c != min_candidate && active(c)) {
+          const int gap = tallies_[c] - min_rating;
+          *margin = min(*margin, gap / 2 + (gap % 2 || c > min_candidate));
+        }
+      }
+    }
+    // Deactivate the candidate with the least first preferences and transfer
+    // its ballots to their next active preferences.
+    Deactivate(min_candidate);
+    --num_active;
+    int node = buckets_[min_candidate];
+    buckets_[min_candidate] = kInvalidId;
+    while (node != kInvalidId) {
+      const int next = next_[node];
+      if (trie_.tail(node)) {
+        TransferTail(node);
+      } else {
+        for (int child = trie_.first_child(node), end = trie_.end(node);
+             child < end; child = trie_.end(child)) {
+          Transfer(child);
+        }
+      }
+      node = next;
+    }
+    for (auto it = singles_.begin(), end = singles_.end(); it != end; ++it) {
+      if (it->cursor < num_candidates_ &&
+          it->row[it->cursor] == min_candidate) {
+        Transfer(&*it);
+      }
+    }
+  }
+  return kInvalidId;
+}
+
+template<class VoteType>
+const VoteType& IrvCounter<VoteType>::vote() const {
+  return vote_;
+}
+
+template<class VoteType>
+void IrvCounter<VoteType>::Transfer(const int node) {
+  if (trie_.tail(node)) {
+    cursors_[node] = 0;
+    TransferTail(node);
+    return;
+  }
+  const int candidate = trie_.candidate(node);
+  if (active(candidate)) {
+    tallies_[candidate] += trie_.count(node);
+    next_[node] = buckets_[candidate];
+    buckets_[candidate] = node;
+    return;
+  }
+  // The candidate was eliminated before the node was reached.
+  for (int child = trie_.first_child(node), end = trie_.end(node);
+       child < end; child = trie_.end(child)) {
+    Transfer(child);
+  }
+}
+
+template<class VoteType>
+void IrvCounter<VoteType>::TransferTail(const int node) {
+  const typename VoteType::IdType* row = trie_.tail_row(node);
+  const int size = trie_.tail_size(node);
+  int& cursor = cursors_[node];
+  while (cursor < size && !active(row[cursor])) {
+    ++cursor;
+  }
+  if (cursor == size) {
+    // Exhausted ballot.
+    return;
+  }
+  const int candidate = row[cursor];
+  tallies_[candidate] += trie_.count(node);
+  next_[node] = buckets_[candidate];
+  buckets_[candidate] = node;
+}
+
+template<class VoteType>
+void IrvCounter<VoteType>::Transfer(Single* single) {
+  while (single->cursor < num_candidates_ &&
+         !active(single->row[single->cursor])) {
+    ++single->cursor;
+  }
+  if (single->cursor < num_candidates_) {
+    tallies_[single->row[single->cursor]] += single->weight;
+  }
+}
+
+template<class VoteType>
+bool IrvCounter<VoteType>::active(const int candidate) const {
+  return (active_[candidate >> 6] >> (candidate & 63)) & 1;
+}
+
+template<class VoteType>
+void IrvCounter<VoteType>::Deactivate(const int candidate) {
+  active_[candidate >> 6] &= ~(uint64_t(1) << (candidate & 63));
+}
+
+template class IrvCounter<Vote>;
+template class IrvCounter<CompactVote>;
+
+}  // namespace bush
@@ -0,0 +1,83 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_IRV_COUNTER_H_
+#define SRC_IRV_COUNTER_H_
+
+#include <cstdint>
+#include <vector>
+#include "./ballot-trie.h"
+#include "./coalition.h"
+
+namespace bush {
+
+// Instant-runoff counting kernel on the prefix trie of a vote's ballots.
+// The topmost trie nodes of each active candidate are bucketed by that
+// candidate, so an elimination round only touches the subtrees which are
+// transferred. Tails keep a cursor to their top active candidate. The
+// selected voter is singled out by counting its ballot negatively and its
+// preference positively next to the trie, a coalition by counting each of its
+// ballots negatively with its number of coalition voters and the joint
+// preference positively with the coalition size. All scratch buffers are
+// allocated once on construction, a count does not allocate unless a
+// coalition with more ballots than before is singled out.
+template<class VoteType>
+class IrvCounter {
+ public:
+  static const int kInvalidId = -1;
+
+  explicit IrvCounter(const VoteType& vote);
+
+  // Returns the winner, with the selected voter voting the given preference
+  // instead of its ballot.
+  int FindWinner(const int selected_voter, const std::vector<int>& preference);
+  // Returns the winner, with all coalition voters voting the given preference
+  // instead of their ballots.
+  int FindWinner(const Coalition<VoteType>& coalition,
+                 const std::vector<int>& preference);
+  // Returns the least number of voters who need to change their ballots to
+  // alter any round of the count, with the selected voter voting the given
+  // preference. Each voter moves at most one vote per round, so fewer voters
+  // cannot change the winner.
+  int Margin(const int selected_voter, const std::vector<int>& preference);
+  const VoteType& vote() const;
+
+ private:
+  // Ballot outside of the trie, counted with given weight for its top active
+  // candidate.
+  struct Single {
+    const int* row;
+    int weight;
+    int cursor;
+  };
+
+  // Singles out the selected voter voting the given preference.
+  void SingleOut(const int selected_voter, const std::vector<int>& preference);
+  // Counts the vote with the singled out ballots and returns the winner. Sets
+  // the margin if kMargin is set, the plain count does not pay for it.
+  template<bool kMargin>
+  int Count(int* margin);
+  // Moves the newly reached node onto the bucket of its candidate if it is
+  // active, otherwise its children.
+  void Transfer(const int node);
+  // Moves the tail node onto the bucket of its top active candidate.
+  void TransferTail(const int node);
+  // Counts the single ballot for its top active candidate.
+  void Transfer(Single* single);
+  bool active(const int candidate) const;
+  void Deactivate(const int candidate);
+
+  const VoteType& vote_;
+  BallotTrie<VoteType> trie_;
+  int num_candidates_;
+  // Singled out ballots and the copies of their rows.
+  std::vector<Single> singles_;
+  std::vector<int> single_rows_;
+  // Row positions of the tails' top active candidates.
+  std::vector<int> cursors_;
+  std::vector<int> next_;
+  std::vector<int> buckets_;
+  std::vector<int> tallies_;
+  std::vector<uint64_t> active_;
+};
+
+}  // namespace bush
+#endif  // SRC_IRV_COUNTER_H_
@@ -0,0 +1,198 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./irv-evaluator.h"
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include "./stats.h"
+#include "./vote.h"
+
+using std::vector;
+using std::copy;
+using std::numeric_limits;
+using base::Stats;
+
+namespace bush {
+
+// Elimination round of the active candidates.
+static const int kActive = numeric_limits<int>::max();
+
+template<class VoteType>
+const int IrvEvaluator<VoteType>::kInvalidId;
+
+template<class VoteType>
+IrvEvaluator<VoteType>::IrvEvaluator(const VoteType& vote,
+                                     const int selected_voter)
+    : vote_(vote),
+      num_candidates_(vote.num_candidates()),
+      num_ballots_(vote.num_ballots()),
+      plurality_(vote.num_voters() / 2),
+      weights_(num_ballots_),
+      cursors_(num_ballots_, 0),
+      next_(num_ballots_, kInvalidId),
+      buckets_(num_candidates_, kInvalidId),
+      tallies_(num_candidates_, 0),
+      elimination_rounds_(num_candidates_, kActive) {
+  const int selected_ballot = vote.voter_ballot(selected_voter);
+  for (int b = 0; b < num_ballots_; ++b) {
+    weights_[b] = vote.count(b) - (b == selected_ballot);
+    if (weights_[b]) {
+      Transfer(b);
+    }
+  }
+}
+
+template<class VoteType>
+int IrvEvaluator<VoteType>::FindWinner(const vector<int>& preference) {
+  assert(static_cast<int>(preference.size()) == num_candidates_);
+  Stats::Count(Stats::kFindWinnerCalls);
+  const int num_rounds = rounds_.size();
+  int cursor = 0;
+  for (int r = 0; r < num_rounds; ++r) {
+    while (!active(preference[cursor], r)) {
+      ++cursor;
+    }
+    const int choice = preference[cursor];
+    Round& round = rounds_[r];
+    if (choice == round.choice) {
+      // Same tallies, same outcome.
+      continue;
+    }
+    bool winner = false;
+    const int outcome = Decide(round_tallies_.data() + r * num_candidates_,
+                               r, choice, &winner);
+    if (winner == round.winner && outcome == round.outcome) {
+      // The other voters' ballots are transferred the same way.
+      round.choice = choice;
+      continue;
+    }
+    Undo(r);
+    return Count(preference, r);
+  }
+  if (rounds_.empty()) {
+    return Count(preference, 0);
+  }
+  assert(rounds_.back().winner);
+  return rounds_.back().outcome;
+}
+
+template<class VoteType>
+int IrvEvaluator<VoteType>::Count(const vector<int>& preference, int round) {
+  int cursor = 0;
+  while (true) {
+    while (!active(preference[cursor], round)) {
+      ++cursor;
+    }
+    const int choice = preference[cursor];
+    round_tallies_.resize((round + 1) * num_candidates_);
+    copy(tallies_.begin(), tallies_.end(),
+         round_tallies_.begin() + round * num_candidates_);
+    bool winner = false;
+    const int outcome = Decide(tallies_.data(), round, choice, &winner);
+    const Round record = {choice, outcome, winner, log_ballots_.size()};
+    rounds_.push_back(record);
+    Stats::Count(Stats::kIrvRounds);
+    if (winner) {
+      return outcome;
+    }
+    // Transfer the eliminated candidate's ballots to their next active
+    // preferences.
+    elimination_rounds_[outcome] = round;
+    int ballot = buckets_[outcome];
+    buckets_[outcome] = kInvalidId;
+    while (ballot != kInvalidId) {
+      const int next = next_[ballot];
+      log_ballots_.push_back(ballot);
+      log_cursors_.push_back(cursors_[ballot]);
+      Transfer(ballot);
+      ballot = next;
+    }
+    ++round;
+  }
+}
+
+template<class VoteType>
+int IrvEvaluator<VoteType>::Decide(const int* tallies, const int round,
+                                   const int choice, bool* winner) const {
+  int min_rating = numeric_limits<int>::max();
+  int min_candidate = kInvalidId;
+  for (int c = 0; c < num_candidates_; ++c) {
+    if (!active(c, round)) {
+      continue;
+    }
+    const int rating = tallies[c] + (c == choice);
+    if (rating > plurality_) {
+      *winner = true;
+      return c;
+    }
+    if (rating < min_rating) {
+      min_rating = rating;
+      min_candidate = c;
+    }
+  }
+  assert(min_candidate != kInvalidId);
+  *winner = false;
+  return min_candidate;
+}
+
+template<class VoteType>
+void IrvEvaluator<VoteType>::Undo(const int round) {
+  const Id* ballots = vote_.ballots().data();
+  for (int r = rounds_.size() - 1; r >= round; --r) {
+    const Round& record = rounds_[r];
+    if (record.winner) {
+      continue;
+    }
+    // Transfers are undone in reverse order, so each ballot is on top of its
+    // bucket.
+    const int eliminated = record.outcome;
+    for (size_t i = log_ballots_.size(); i > record.log_begin; --i) {
+      const int ballot = log_ballots_[i - 1];
+      const int cursor = cursors_[ballot];
+      if (cursor < num_candidates_) {
+        const int candidate =
+            ballots[static_cast<size_t>(ballot) * num_candidates_ + cursor];
+        assert(buckets_[candidate] == ballot);
+        buckets_[candidate] = next_[ballot];
+        tallies_[candidate] -= weights_[ballot];
+      }
+      cursors_[ballot] = log_cursors_[i - 1];
+      next_[ballot] = buckets_[eliminated];
+      buckets_[eliminated] = ballot;
+    }
+    log_ballots_.resize(record.log_begin);
+    log_cursors_.resize(record.log_begin);
+    elimination_rounds_[eliminated] = kActive;
+  }
+  rounds_.resize(round);
+  round_tallies_.resize(round * num_candidates_);
+}
+
+template<class VoteType>
+void IrvEvaluator<VoteType>::Transfer(const int ballot) {
+  const Id* row = vote_.ballots().data() +
+                  static_cast<size_t>(ballot) * num_candidates_;
+  int& cursor = cursors_[ballot];
+  while (cursor < num_candidates_ &&
+         elimination_rounds_[row[cursor]] != kActive) {
+    ++cursor;
+  }
+  if (cursor == num_candidates_) {
+    // Exhausted ballot.
+    return;
+  }
+  const int candidate = row[cursor];
+  tallies_[candidate] += weights_[ballot];
+  next_[ballot] = buckets_[candidate];
+  buckets_[candidate] = ballot;
+}
+
+template<class VoteType>
+bool IrvEvaluator<VoteType>::active(const int candidate,
+                                    const int round) const {
+  return elimination_rounds_[candidate] >= round;
+}
+
+template class IrvEvaluator<Vote>;
+template class IrvEvaluator<CompactVote>;
+
+}  // namespace bush
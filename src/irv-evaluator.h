@@ -0,0 +1,77 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_IRV_EVALUATOR_H_
+#define SRC_IRV_EVALUATOR_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace bush {
+
+// Incremental instant-runoff count of a vote with changing preferences of the
+// selected voter. The count state of the other voters' ballots depends only
+// on the sequence of eliminations, so it is kept between evaluations together
+// with the tallies and the selected voter's choice of every round. A new
+// preference only changes the rounds in which its top active candidate
+// differs; rounds whose outcome stays the same are reused as they are. From
+// the first round with a different outcome on, the transfers are undone
+// along a log and the count is replayed.
+template<class VoteType>
+class IrvEvaluator {
+ public:
+  typedef typename VoteType::IdType Id;
+
+  static const int kInvalidId = -1;
+
+  // Initialises the evaluator for the selected voter, whose ballot in the
+  // vote is ignored.
+  IrvEvaluator(const VoteType& vote, const int selected_voter);
+
+  // Returns the winner with the selected voter voting the given preference.
+  int FindWinner(const std::vector<int>& preference);
+
+ private:
+  // Round of the count with the selected voter's choice and the winner or the
+  // eliminated candidate, whose transfers start at the log position.
+  struct Round {
+    int choice;
+    int outcome;
+    bool winner;
+    size_t log_begin;
+  };
+
+  // Counts the rounds from the given round on, the state must be at its
+  // start. Returns the winner.
+  int Count(const std::vector<int>& preference, int round);
+  // Returns the winner or the eliminated candidate of the round for the other
+  // voters' tallies and the selected voter's choice. Sets winner accordingly.
+  int Decide(const int* tallies, const int round, const int choice,
+             bool* winner) const;
+  // Undoes the rounds from the given round on.
+  void Undo(const int round);
+  // Moves the ballot onto the bucket of its top active candidate.
+  void Transfer(const int ballot);
+  // Returns whether the candidate is active at the start of the round.
+  bool active(const int candidate, const int round) const;
+
+  const VoteType& vote_;
+  int num_candidates_;
+  int num_ballots_;
+  int plurality_;
+  // Ballot weights without the selected voter.
+  std::vector<int> weights_;
+  std::vector<int> cursors_;
+  std::vector<int> next_;
+  std::vector<int> buckets_;
+  std::vector<int> tallies_;
+  // The round each candidate is eliminated in, kActive for active ones.
+  std::vector<int> elimination_rounds_;
+  std::vector<Round> rounds_;
+  // The other voters' tallies at the start of each round, row by row.
+  std::vector<int> round_tallies_;
+  // Transferred ballots and their cursors before the transfer.
+  std::vector<int> log_ballots_;
+  std::vector<int> log_cursors_;
+};
+
+}  // namespace bush
+#endif  // SRC_IRV_EVALUATOR_H_
@@ -0,0 +1,238 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./irv-solver.h"
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include "./vote.h"
+
+using std::vector;
+using std::max;
+using std::stable_sort;
+using std::numeric_limits;
+using base::Deadline;
+
+namespace bush {
+
+template<class VoteType>
+const int IrvSolver<VoteType>::kMaxCandidates;
+
+// Returns the set containing only the given candidate.
+static inline uint64_t Bit(const int candidate) {
+  return uint64_t(1) << candidate;
+}
+
+template<class VoteType>
+IrvSolver<VoteType>::IrvSolver(const VoteType& vote, const int selected_voter)
+    : num_candidates_(vote.num_candidates()),
+      plurality_(vote.num_voters() / 2),
+      trie_(vote),
+      selected_row_(vote.ballot(vote.voter_ballot(selected_voter)).begin()),
+      best_utility_(0),
+      deadline_(nullptr),
+      timeout_(false) {
+  assert(num_candidates_ <= kMaxCandidates);
+}
+
+template<class VoteType>
+vector<int> IrvSolver<VoteType>::Solve(const vector<int>& sincere,
+                                       const vector<int>& ratings,
+                                       Deadline* deadline,
+                                       bool* optimal) {
+  assert(static_cast<int>(sincere.size()) == num_candidates_);
+  assert(static_cast<int>(ratings.size()) == num_candidates_);
+  deadline_ = deadline;
+  timeout_ = false;
+  ratings_ = ratings;
+  order_.resize(num_candidates_);
+  for (int c = 0; c < num_candidates_; ++c) {
+    order_[c] = c;
+  }
+  stable_sort(order_.begin(), order_.end(), [&ratings](const int lhs,
+                                                       const int rhs) {
+    return ratings[lhs] > ratings[rhs];
+  });
+  best_utilities_.clear();
+  choices_.clear();
+  best_choices_.clear();
+
+  const Set all = num_candidates_ == kMaxCandidates ?
+                  numeric_limits<Set>::max() : Bit(num_candidates_) - 1;
+  // The utility of the sincere preference is the one to beat.
+  Set active = all;
+  int cursor = 0;
+  bool winner = false;
+  while (!winner) {
+    while (!(active & Bit(sincere[cursor]))) {
+      ++cursor;
+    }
+    const int candidate = Round(active, sincere[cursor], &winner);
+    if (winner) {
+      best_utility_ = ratings_[candidate];
+    }
+    active &= ~Bit(candidate);
+  }
+  Best(all);
+  *optimal = !timeout_;
+  if (best_choices_.empty()) {
+    return sincere;
+  }
+  // The vote moves along the choices, the remaining candidates never receive
+  // it and follow in sincere order.
+  vector<int> preference = best_choices_;
+  Set chosen = 0;
+  for (auto it = best_choices_.cbegin(), end = best_choices_.cend();
+       it != end; ++it) {
+    chosen |= Bit(*it);
+  }
+  for (auto it = sincere.cbegin(), end = sincere.cend(); it != end; ++it) {
+    if (!(chosen & Bit(*it))) {
+      preference.push_back(*it);
+    }
+  }
+  return preference;
+}
+
+template<class VoteType>
+int IrvSolver<VoteType>::Best(const Set active) {
+  if (timeout_) {
+    return -1;
+  } else if (deadline_->Expired()) {
+    timeout_ = true;
+    return -1;
+  }
+  auto it = best_utilities_.find(active);
+  if (it != best_utilities_.end()) {
+    // A memoized utility never exceeds the best utility found so far, which
+    // was updated when it was reached.
+    return it->second;
+  }
+  const int max_rating = MaxRating(active);
+  if (max_rating <= best_utility_) {
+    // Pruned, the utilities of pruned branches are not memoized.
+    return -1;
+  }
+  int best = -1;
+  for (auto it = order_.cbegin(), end = order_.cend(); it != end; ++it) {
+    const int candidate = *it;
+    if (!(active & Bit(candidate))) {
+      continue;
+    }
+    choices_.push_back(candidate);
+    best = max(best, Follow(active, candidate));
+    choices_.pop_back();
+    if (timeout_) {
+      return best;
+    } else if (best_utility_ == max_rating) {
+      // No choice can do better.
+      break;
+    }
+  }
+  // Branches pruned on the way are worse than the best utility found so far,
+  // the memoized utility is therefore sufficient for later pruning.
+  best_utilities_[active] = best;
+  return best;
+}
+
+template<class VoteType>
+int IrvSolver<VoteType>::Follow(Set active, const int choice) {
+  while (true) {
+    bool winner = false;
+    const int candidate = Round(active, choice, &winner);
+    if (winner) {
+      const int utility = ratings_[candidate];
+      if (utility > best_utility_) {
+        best_utility_ = utility;
+        best_choices_ = choices_;
+      }
+      return utility;
+    }
+    active &= ~Bit(candidate);
+    if (candidate == choice) {
+      // The manipulator's vote is free to move again.
+      return Best(active);
+    }
+  }
+}
+
+template<class VoteType>
+int IrvSolver<VoteType>::Round(const Set active, const int choice,
+                               bool* winner) {
+  const vector<int>& tally = Tally(active);
+  int min_rating = numeric_limits<int>::max();
+  int min_candidate = -1;
+  for (int c = 0; c < num_candidates_; ++c) {
+    if (!(active & Bit(c))) {
+      continue;
+    }
+    const int rating = tally[c] + (c == choice);
+    if (rating > plurality_) {
+      *winner = true;
+      return c;
+    }
+    if (rating < min_rating) {
+      min_rating = rating;
+      min_candidate = c;
+    }
+  }
+  assert(min_candidate != -1);
+  *winner = false;
+  return min_candidate;
+}
+
+template<class VoteType>
+const vector<int>& IrvSolver<VoteType>::Tally(const Set active) {
+  auto it = tallies_.find(active);
+  if (it != tallies_.end()) {
+    return it->second;
+  }
+  vector<int>& tally = tallies_[active];
+  tally.assign(num_candidates_, 0);
+  const int root = BallotTrie<VoteType>::kRoot;
+  for (int node = trie_.first_child(root), end = trie_.end(root); node < end;
+       node = trie_.end(node)) {
+    Tally(active, node, &tally);
+  }
+  // Ballots are complete, there is always an active candidate.
+  int c = 0;
+  while (!(active & Bit(selected_row_[c]))) {
+    ++c;
+  }
+  --tally[selected_row_[c]];
+  return tally;
+}
+
+template<class VoteType>
+void IrvSolver<VoteType>::Tally(const Set active, const int node,
+                                vector<int>* tally) const {
+  if (trie_.tail(node)) {
+    const typename VoteType::IdType* row = trie_.tail_row(node);
+    int c = 0;
+    while (!(active & Bit(row[c]))) {
+      ++c;
+    }
+    (*tally)[row[c]] += trie_.count(node);
+  } else if (active & Bit(trie_.candidate(node))) {
+    (*tally)[trie_.candidate(node)] += trie_.count(node);
+  } else {
+    for (int child = trie_.first_child(node), end = trie_.end(node);
+         child < end; child = trie_.end(child)) {
+      Tally(active, child, tally);
+    }
+  }
+}
+
+template<class VoteType>
+int IrvSolver<VoteType>::MaxRating(const Set active) const {
+  int max_rating = -1;
+  for (int c = 0; c < num_candidates_; ++c) {
+    if (active & Bit(c)) {
+      max_rating = max(max_rating, ratings_[c]);
+    }
+  }
+  return max_rating;
+}
+
+template class IrvSolver<Vote>;
+template class IrvSolver<CompactVote>;
+
+}  // namespace bush
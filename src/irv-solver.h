@@ -0,0 +1,76 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_IRV_SOLVER_H_
+#define SRC_IRV_SOLVER_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "./ballot-trie.h"
+#include "./deadline.h"
+
+namespace bush {
+
+// Exact strategic preference search of a single manipulator under instant-
+// runoff voting. The manipulator's vote stays with its current candidate
+// until that candidate is eliminated, so a preference is fully described by
+// the sequence of candidates the vote moves to. The search explores these
+// choices depth-first along the elimination order, prunes branches whose
+// active candidates cannot beat the best utility found so far and memoizes
+// the best utility per active candidate set.
+template<class VoteType>
+class IrvSolver {
+ public:
+  // Maximum number of candidates, the active sets are 64-bit masks.
+  static const int kMaxCandidates = 64;
+
+  // Initialises the solver for the selected voter, whose ballot in the vote
+  // is ignored.
+  IrvSolver(const VoteType& vote, const int selected_voter);
+
+  // Returns the preference with the greatest utility for the given ratings,
+  // or the sincere preference if none is better. Sets optimal to whether the
+  // search was completed before the deadline expired. Otherwise the best
+  // preference found so far is returned.
+  std::vector<int> Solve(const std::vector<int>& sincere,
+                         const std::vector<int>& ratings,
+                         base::Deadline* deadline, bool* optimal);
+
+ private:
+  typedef uint64_t Set;
+
+  // Returns the best utility reachable with the manipulator's vote free to
+  // move to any of the active candidates, or -1 if the branch is pruned.
+  int Best(const Set active);
+  // Returns the utility reached with the manipulator voting the given choice
+  // until it is eliminated.
+  int Follow(Set active, const int choice);
+  // Returns the winner or the eliminated candidate of the round, with the
+  // manipulator voting the given choice. Sets winner accordingly.
+  int Round(const Set active, const int choice, bool* winner);
+  // Returns the tallies of the other voters for the active candidates.
+  const std::vector<int>& Tally(const Set active);
+  // Adds the voters of the trie node's subtree to the tallies of their top
+  // active candidates.
+  void Tally(const Set active, const int node, std::vector<int>* tally) const;
+  // Returns the greatest rating among the active candidates.
+  int MaxRating(const Set active) const;
+
+  int num_candidates_;
+  int plurality_;
+  BallotTrie<VoteType> trie_;
+  // The selected voter's ballot, which is not counted.
+  const typename VoteType::IdType* selected_row_;
+  std::unordered_map<Set, std::vector<int> > tallies_;
+  std::unordered_map<Set, int> best_utilities_;
+  std::vector<int> ratings_;
+  // Candidates by decreasing rating, the order in which choices are tried.
+  std::vector<int> order_;
+  std::vector<int> choices_;
+  std::vector<int> best_choices_;
+  int best_utility_;
+  base::Deadline* deadline_;
+  bool timeout_;
+};
+
+}  // namespace bush
+#endif  // SRC_IRV_SOLVER_H_
@@ -1,230 +1,323 @@
 // Copyright 2012 Eugen Sawin <esawin@me73.com>
 #include "./irv-system.h"
-#include <unordered_map>
-#include <unordered_set>
 #include <cassert>
+#include <string>
 #include <vector>
 #include <algorithm>
-#include <queue>
-#include <limits>
 #include <iostream>
 #include "./vote.h"
+#include "./budget-scheduler.h"
+#include "./irv-counter.h"
+#include "./irv-evaluator.h"
+#include "./irv-solver.h"
+#include "./permutation-set.h"
 #include "./random.h"
+#include "./sampler.h"
+#include "./stats.h"
+#include "./trace.h"
 #include "./clock.h"
+#include "./deadline.h"
 
+using std::string;
 using std::vector;
-using std::unordered_map;
-using std::unordered_set;
 using std::pair;
 using std::make_pair;
 using std::sort;
-using std::priority_queue;
-using std::reverse;
 using std::swap;
-using std::numeric_limits;
 using base::RandomGenerator;
+using base::PermutationSet;
 using base::Clock;
+using base::Stats;
+using base::Trace;
+using base::Deadline;
+using base::BudgetScheduler;
 
 namespace bush {
 
-struct Compare {
-  bool operator()(const pair<int, int>& lhs, const pair<int, int>& rhs) const {
-    // Prefer lower rating and lower id (reversed!).
-    return lhs.first > rhs.first ||
-           (lhs.first == rhs.first && lhs.second > rhs.second);
-  }
-};
-
-struct IntVectorHash {
-  size_t operator()(const vector<int>& vec) const {
-    const int size = vec.size();
-    size_t h = size ^ 0x550924F3;
-    for (int i = 0; i < size; ++i) {
-      const int j = i * 3;
-      h ^= (vec[i] << j) ^ (h >> j);
-    }
-    return h;
-  }
-};
+template<class VoteType>
+Irv<VoteType>::Irv(const VoteType& vote,
+                   const VotingSystem::Strategy strategy,
+                   const VotingSystem::Options& options)
+    : vote_(vote),
+      strategy_(strategy),
+      options_(options),
+      strategic_vote_(0, 0),
+      optimal_(false),
+      preprocess_time_(0) {
+  Preprocess(VoteType::kInvalidBallot);
+}
 
-Irv::Irv(const Vote& vote, const int selected_voter_id,
-         const VotingSystem::Strategy strategy)
+template<class VoteType>
+Irv<VoteType>::Irv(const VoteType& vote, const int selected_voter_id,
+                   const VotingSystem::Strategy strategy,
+                   const VotingSystem::Options& options)
     : vote_(vote),
-      selected_voter_(selected_voter_id),
-      time_limit_(VotingSystem::kDefTimeLimit) {
-  Preprocess(strategy);
+      strategy_(strategy),
+      options_(options),
+      strategic_vote_(0, 0),
+      optimal_(false),
+      preprocess_time_(0) {
+  Preprocess(vote.voter_ballot(selected_voter_id));
+  strategic_preference_ = StrategicPreference(selected_voter_id, &optimal_);
 }
 
-void Irv::Preprocess(const VotingSystem::Strategy strategy) {
-  if (strategy == VotingSystem::kSimple) {
-    strategic_preference_ = FindStrategicPreference(vote_, selected_voter_,
-                                                    time_limit_);
-  } else if (strategy == VotingSystem::kComplete) {
-    const Clock beg;
-
-    const int num_voters = vote_.num_voters();
-    const Clock::Diff voter_time = time_limit_ * 0.66 / num_voters;
-    Vote strategic_vote(vote_.num_candidates(), num_voters);
-    strategic_vote.AddPreference(selected_voter_,
-                                 vote_.preference(selected_voter_));
-    for (int v = 0; v < num_voters; ++v) {
-      if (v == selected_voter_) {
-        continue;
-      }
-      strategic_vote.AddPreference(v, FindStrategicPreference(vote_, v,
-                                                              voter_time));
-    }
-    const Clock::Diff rest_time = time_limit_ - (Clock() - beg);
-    strategic_preference_ = FindStrategicPreference(strategic_vote,
-                                                    selected_voter_,
-                                                    rest_time);
-  } else if (strategy == VotingSystem::kIndependent) {
-    const Clock beg;
-    RandomGenerator<float> random(13);
-    const int num_voters = vote_.num_voters();
-    const int num_candidates = vote_.num_candidates();
-    const Clock::Diff voter_time = time_limit_ * 0.1 / num_voters;
-    int checked_hits = 0;
-    int best_utility = 0;
-    const int rand_candidates = num_candidates / 3;
-    const int max_checked_hits = num_candidates * num_voters * rand_candidates;
-    strategic_preference_ = vote_.preference(selected_voter_);
-    unordered_map<vector<int>, int, IntVectorHash> pref_map;
-    while (checked_hits < max_checked_hits &&
-           Clock() - beg < time_limit_) {
-      Vote strategic_vote(vote_.num_candidates(), num_voters);
-      strategic_vote.AddPreference(selected_voter_,
-                                   vote_.preference(selected_voter_));
-      for (int v = 0; v < num_voters; ++v) {
-        if (v == selected_voter_) {
-          continue;
-        }
-        vector<int> voter_pref = vote_.preference(v);
-        for (int r = 0; r < rand_candidates; ++r) {
-          swap(voter_pref[random.Next() * num_candidates],
-               voter_pref[random.Next() * num_candidates]);
-        }
-        strategic_vote.AddPreference(v, voter_pref);
-      }
-      vector<int> preference = FindStrategicPreference(strategic_vote,
-                                                       selected_voter_,
-                                                       voter_time);
-      const int utility = Utility(vote_, selected_voter_, preference);
-      auto find = pref_map.find(preference);
-      if (find == pref_map.end()) {
-        checked_hits = 0;
-        find = pref_map.insert(make_pair(preference, utility)).first;
-      } else {
-        ++checked_hits;
-        find->second += utility;
-      }
-      if (find->second > best_utility) {
-        strategic_preference_ = find->first;
-        best_utility = find->second;
-      }
+template<class VoteType>
+void Irv<VoteType>::Preprocess(const int selected_ballot) {
+  if (strategy_ != VotingSystem::kComplete) {
+    return;
+  }
+  Stats::PhaseTimer timer(Stats::kPreprocess);
+  Trace::Span span("irv.preprocess");
+  // Time of the calling thread outside of the voter searches, on the clock of
+  // the time limit. The searches account their own time on all threads.
+  const Clock beg(options_.clock_type);
+
+  const int num_voters = vote_.num_voters();
+  const int num_ballots = vote_.num_ballots();
+  // Voters sharing a ballot share their strategic preference, it is searched
+  // once per ballot for a representative voter, weighted by the number of the
+  // ballot's voters.
+  vector<int> ballot_voters(num_ballots);
+  for (int v = num_voters - 1; v >= 0; --v) {
+    ballot_voters[vote_.voter_ballot(v)] = v;
+  }
+  // Triage, the voters of a ballot keep their sincere preference if its
+  // first choice wins or if no single voter can change the outcome. A vote
+  // without voters has no ballots to search.
+  int winner = -1;
+  bool pivotal = false;
+  if (num_voters) {
+    IrvCounter<VoteType> counter(vote_);
+    const typename VoteType::Row first = vote_.preference(0);
+    const vector<int> first_pref(first.begin(), first.end());
+    winner = counter.FindWinner(0, first_pref);
+    pivotal = counter.Margin(0, first_pref) <= 1;
+  }
+  vector<vector<int> > ballot_prefs(num_ballots);
+  vector<int> weights(num_ballots, 0);
+  for (int b = 0; b < num_ballots; ++b) {
+    const typename VoteType::Row ballot = vote_.ballot(b);
+    ballot_prefs[b].assign(ballot.begin(), ballot.end());
+    if (pivotal && ballot[0] != winner) {
+      // Only the selected voter votes a ballot of weight 0.
+      weights[b] = vote_.count(b) - (b == selected_ballot);
     }
-  } else {
-    strategic_preference_ = vote_.preference(selected_voter_);
   }
+  BudgetScheduler scheduler(options_.clock_type, options_.time_limit * 0.66,
+                            options_.num_threads);
+  const Clock::Diff triage_time = Clock(options_.clock_type) - beg;
+  search_report_ = scheduler.Run(weights, [&](const int b,
+                                              Deadline* deadline) {
+    Trace::Span span("irv.voter_search", ballot_voters[b]);
+    bool optimal = false;
+    vector<int> pref = FindStrategicPreference(vote_, vote_, ballot_voters[b],
+                                               options_.exact, deadline,
+                                               &optimal);
+    const bool improved = pref != ballot_prefs[b];
+    ballot_prefs[b].swap(pref);
+    return improved;
+  });
+  const Clock merge_beg(options_.clock_type);
+  strategic_vote_ = VoteType(vote_.num_candidates(), num_voters);
+  vector<int> strategic_ballots(num_ballots);
+  for (int b = 0; b < num_ballots; ++b) {
+    strategic_ballots[b] = strategic_vote_.AddBallot(ballot_prefs[b]);
+  }
+  for (int v = 0; v < num_voters; ++v) {
+    strategic_vote_.AssignBallot(v, strategic_ballots[vote_.voter_ballot(v)]);
+  }
+  preprocess_time_ = triage_time + search_report_.spent +
+                     (Clock(options_.clock_type) - merge_beg);
+}
+
+template<class VoteType>
+vector<int> Irv<VoteType>::StrategicPreference(
+    const int selected_voter) const {
+  bool optimal = false;
+  return StrategicPreference(selected_voter, &optimal);
 }
 
-vector<int> Irv::FindStrategicPreference(const Vote& vote,
-                                         const int selected_voter,
-                                         const Clock::Diff time_limit) {
-  const Clock beg;
+template<class VoteType>
+vector<int> Irv<VoteType>::StrategicPreference(const int selected_voter,
+                                               bool* optimal) const {
+  Stats::PhaseTimer timer(Stats::kSearch);
+  Trace::Span span("irv.search", selected_voter);
+  *optimal = false;
+  if (strategy_ == VotingSystem::kSimple) {
+    Deadline deadline(options_.clock_type, options_.time_limit);
+    return FindStrategicPreference(vote_, vote_, selected_voter,
+                                   options_.exact, &deadline, optimal);
+  } else if (strategy_ == VotingSystem::kComplete) {
+    // The other voters vote their strategic preferences.
+    Deadline deadline(options_.clock_type,
+                      options_.time_limit - preprocess_time_);
+    return FindStrategicPreference(strategic_vote_, vote_, selected_voter,
+                                   options_.exact, &deadline, optimal);
+  } else if (strategy_ == VotingSystem::kIndependent) {
+    const Clock::Diff voter_time =
+        options_.time_limit * 0.1 / vote_.num_voters();
+    // Thread-local counters for the utility on the sincere vote.
+    vector<IrvCounter<VoteType> > counters(options_.num_threads,
+                                           IrvCounter<VoteType>(vote_));
+    const typename VoteType::RatingRow ratings = vote_.ratings(selected_voter);
+    Sampler<VoteType> sampler(vote_, selected_voter, options_.num_threads,
+                              options_.clock_type, options_.time_limit);
+    const Clock::Type clock_type = options_.clock_type;
+    const bool exact = options_.exact;
+    // The sampled preferences are not proven to be optimal.
+    return sampler.Run(
+        [selected_voter, voter_time, clock_type, exact, &counters, &ratings](
+            const VoteType& sample, const int thread_id, int* utility) {
+      Deadline deadline(clock_type, voter_time);
+      bool optimal = false;
+      vector<int> preference = FindStrategicPreference(sample, sample,
+                                                       selected_voter, exact,
+                                                       &deadline, &optimal);
+      *utility = Utility(&counters[thread_id], selected_voter, ratings,
+                         preference);
+      return preference;
+    });
+  }
+  const typename VoteType::Row pref = vote_.preference(selected_voter);
+  return vector<int>(pref.begin(), pref.end());
+}
 
-  unordered_set<vector<int>, IntVectorHash> checked;
+template<class VoteType>
+vector<int> Irv<VoteType>::FindStrategicPreference(
+    const VoteType& vote, const VoteType& sincere_vote,
+    const int selected_voter, const bool exact, Deadline* deadline,
+    bool* optimal) {
+  if (exact && vote.num_candidates() <= IrvSolver<VoteType>::kMaxCandidates) {
+    const typename VoteType::Row sincere =
+        sincere_vote.preference(selected_voter);
+    const typename VoteType::RatingRow ratings =
+        sincere_vote.ratings(selected_voter);
+    IrvSolver<VoteType> solver(vote, selected_voter);
+    return solver.Solve(vector<int>(sincere.begin(), sincere.end()),
+                        vector<int>(ratings.begin(), ratings.end()),
+                        deadline, optimal);
+  }
+  PermutationSet checked(vote.num_candidates());
   RandomGenerator<float> random(12);
   const int num_candidates = vote.num_candidates();
   const int max_utility = num_candidates - 1;
 
-  vector<int> strategic_preference = vote.preference(selected_voter);
-  vector<int> preference = vote.preference(selected_voter);
-  int best_utility = Utility(vote, selected_voter, preference);
+  const typename VoteType::Row sincere =
+      sincere_vote.preference(selected_voter);
+  const typename VoteType::RatingRow ratings =
+      sincere_vote.ratings(selected_voter);
+  vector<int> strategic_preference(sincere.begin(), sincere.end());
+  vector<int> preference = strategic_preference;
+  // Neighbouring preferences share most rounds of the count.
+  IrvEvaluator<VoteType> evaluator(vote, selected_voter);
+  int best_utility = ratings[evaluator.FindWinner(preference)];
+  Stats::Count(Stats::kUtilityCalls);
   int checked_hits = 0;
   const int max_checked_hits = num_candidates;
   while (checked_hits < max_checked_hits &&
          best_utility < max_utility &&
-         Clock() - beg < time_limit) {
+         !deadline->Expired()) {
     swap(preference[random.Next() * num_candidates],
          preference[random.Next() * num_candidates]);
-    if (checked.find(preference) != checked.end()) {
+    if (!checked.Insert(preference)) {
+      Stats::Count(Stats::kVisitedHits);
       ++checked_hits;
       continue;
     }
+    Stats::Count(Stats::kVisitedMisses);
     checked_hits = 0;
-    checked.insert(preference);
-    const int utility = Utility(vote, selected_voter, preference);
+    const int utility = ratings[evaluator.FindWinner(preference)];
+    Stats::Count(Stats::kUtilityCalls);
     if (utility > best_utility) {
       best_utility = utility;
       strategic_preference.swap(preference);
     }
   }
+  // Only the greatest possible utility proves a random search result.
+  *optimal = best_utility == max_utility;
   return strategic_preference;
 }
 
-int Irv::FindWinner(const Vote& vote, const int selected_voter,
-                    const vector<int>& preference) {
-  static const int kInvalidId = -1;
+template<class VoteType>
+string Irv<VoteType>::Name() {
+  return "irv";
+}
+
+template<class VoteType>
+const vector<int>& Irv<VoteType>::strategic_preference() const {
+  return strategic_preference_;
+}
+
+template<class VoteType>
+bool Irv<VoteType>::optimal() const {
+  return optimal_;
+}
+
+template<class VoteType>
+const BudgetScheduler::Report& Irv<VoteType>::search_report() const {
+  return search_report_;
+}
+
 
-  const int num_voters = vote.num_voters();
+template<class VoteType>
+vector<int> Irv<VoteType>::CoalitionPreference(
+    const Coalition<VoteType>& coalition, Deadline* deadline,
+    int* sincere_winner, int* winner) {
+  Trace::Span span("irv.coalition_search", coalition.size());
+  const VoteType& vote = coalition.vote();
   const int num_candidates = vote.num_candidates();
-  vector<vector<int> > prefs;
-  prefs.reserve(num_voters);
-  for (int v = 0; v < num_voters; ++v) {
-    if (v == selected_voter) {
-      prefs.push_back(preference);
-    } else {
-      prefs.push_back(vote.preference(v));
-    }
-    reverse(prefs.back().begin(), prefs.back().end());
-  }
-  vector<bool> active(num_candidates, true);
-  const int plurality = num_voters / 2;
-  int winner = kInvalidId;
-  while (winner == kInvalidId) {
-    vector<int> ratings(num_candidates, 0);
-    for (auto it = prefs.begin(), end = prefs.end(); it != end; ++it) {
-      vector<int>& voter_prefs = *it;
-      while (voter_prefs.size() && !active[voter_prefs.back()]) {
-        voter_prefs.pop_back();
+  IrvCounter<VoteType> counter(vote);
+  const typename VoteType::Row first = vote.preference(0);
+  *sincere_winner = counter.FindWinner(0, vector<int>(first.begin(),
+                                                      first.end()));
+  *winner = *sincere_winner;
+  const vector<int> ranking = coalition.Ranking();
+  const vector<int> targets = coalition.Targets(*sincere_winner);
+  vector<int> pref;
+  pref.reserve(num_candidates);
+  for (auto it = targets.cbegin(), end = targets.cend(); it != end; ++it) {
+    const int target = *it;
+    // The leader is pushed over in front of the target, the target leads
+    // itself first. The best target leading itself is tried even if the
+    // deadline has already expired.
+    for (int l = -1; l < num_candidates &&
+                     ((it == targets.cbegin() && l == -1) ||
+                      !deadline->Expired()); ++l) {
+      const int leader = l == -1 ? target : ranking[l];
+      if (l != -1 && leader == target) {
+        continue;
       }
-      if (voter_prefs.size()) {
-        if (++ratings[voter_prefs.back()] > plurality) {
-          // Winner found.
-          winner = voter_prefs.back();
-          break;
-        }
+      pref.assign(1, leader);
+      if (leader != target) {
+        pref.push_back(target);
       }
-    }
-    int min_rating = numeric_limits<int>::max();
-    int min_candidate = kInvalidId;
-    for (int i = 0; i < num_candidates; ++i) {
-      const int rating = ratings[i];
-      if (active[i] && rating < min_rating) {
-        min_rating = rating;
-        min_candidate = i;
-        if (min_rating == 0) {
-          // Found minimum.
-          break;
+      for (auto r = ranking.cbegin(), r_end = ranking.cend(); r != r_end;
+           ++r) {
+        if (*r != leader && *r != target) {
+          pref.push_back(*r);
         }
       }
+      if (counter.FindWinner(coalition, pref) == target) {
+        *winner = target;
+        return pref;
+      }
     }
-    assert(min_candidate != kInvalidId);
-    // Deactive the candidate with the least first preferences.
-    active[min_candidate] = false;
   }
-  return winner;
+  // No joint ballot is reported, the voters keep their sincere ballots.
+  return vector<int>();
 }
 
-const vector<int>& Irv::strategic_preference() const {
-  return strategic_preference_;
+template<class VoteType>
+int Irv<VoteType>::Utility(IrvCounter<VoteType>* counter,
+                           const int selected_voter,
+                           const typename VoteType::RatingRow& ratings,
+                           const vector<int>& pref) {
+  Stats::Count(Stats::kUtilityCalls);
+  const int winner = counter->FindWinner(selected_voter, pref);
+  return ratings[winner];
 }
 
-
-int Irv::Utility(const Vote& vote, const int selected_voter,
-                 const vector<int>& pref) {
-  return vote.ratings(selected_voter)[FindWinner(vote, selected_voter, pref)];
-}
+template class Irv<Vote>;
+template class Irv<CompactVote>;
 
 }  // namespace bush
@@ -2,37 +2,86 @@
 #ifndef SRC_IRV_SYSTEM_H_
 #define SRC_IRV_SYSTEM_H_
 
+#include <string>
 #include <vector>
+#include "./budget-scheduler.h"
 #include "./clock.h"
+#include "./coalition.h"
+#include "./deadline.h"
 #include "./voting-system.h"
 
 namespace bush {
 
-class Vote;
+template<class VoteType> class IrvCounter;
 
+template<class VoteType>
 class Irv {
  public:
-  Irv(const Vote& vote, const int selected_voter_id,
-      const VotingSystem::Strategy strategy);
+  // Returns the name of the voting system.
+  static std::string Name();
+  // Returns the joint preference of the coalition against the sincere other
+  // voters. For the shared targets, best first, it tries the target first
+  // followed by the coalition's ranking, then each other candidate first to
+  // push the target over, followed by the target and the ranking. Returns
+  // an empty preference if no target wins before the deadline expires, the
+  // coalition's voters then keep their sincere ballots. Sets the sincere
+  // winner and the winner, which is the sincere winner if the preference is
+  // empty.
+  static std::vector<int> CoalitionPreference(
+      const Coalition<VoteType>& coalition, base::Deadline* deadline,
+      int* sincere_winner, int* winner);
+
+  // Precomputes the strategy for queries of any selected voter.
+  Irv(const VoteType& vote, const VotingSystem::Strategy strategy,
+      const VotingSystem::Options& options);
+  // Precomputes the strategy and computes the strategic preference of the
+  // selected voter.
+  Irv(const VoteType& vote, const int selected_voter_id,
+      const VotingSystem::Strategy strategy,
+      const VotingSystem::Options& options);
+  // Returns the strategic preference of the selected voter.
+  std::vector<int> StrategicPreference(const int selected_voter) const;
+  // Returns the strategic preference of the selected voter and sets optimal
+  // to whether it is proven to be the best response to the other voters.
+  std::vector<int> StrategicPreference(const int selected_voter,
+                                       bool* optimal) const;
   const std::vector<int>& strategic_preference() const;
-  void time_limit(const base::Clock::Diff limit);
-  base::Clock::Diff time_limit() const;
+  // Returns whether the strategic preference is proven to be optimal.
+  bool optimal() const;
+  // Returns how the nixon precomputation spent its search budget.
+  const base::BudgetScheduler::Report& search_report() const;
 
  private:
-  void Preprocess(const VotingSystem::Strategy strategy);
-  static std::vector<int> FindStrategicPreference(const Vote& vote,
+  // Searches the nixon strategic preferences of all ballots but the selected
+  // voter's, if it is the ballot's only voter. The search budget is scheduled
+  // over the ballots whose voters may gain from a strategic preference.
+  void Preprocess(const int selected_ballot);
+  // Searches the strategic preference of the selected voter against the
+  // other voters' ballots of the vote, the selected voter's sincere
+  // preference and ratings are taken from the sincere vote. Returns the best
+  // preference found when the deadline expires and sets optimal to whether
+  // it is proven to be the best.
+  static std::vector<int> FindStrategicPreference(const VoteType& vote,
+                                                  const VoteType& sincere_vote,
                                                   const int selected_voter,
-                                                  const base::Clock::Diff
-                                                        time_limit);
-  static int FindWinner(const Vote& vote, const int selected_voter,
-                        const std::vector<int>& preference);
-  static int Utility(const Vote& vote, const int selected_voter,
+                                                  const bool exact,
+                                                  base::Deadline* deadline,
+                                                  bool* optimal);
+  static int Utility(IrvCounter<VoteType>* counter, const int selected_voter,
+                     const typename VoteType::RatingRow& ratings,
                      const std::vector<int>& preference);
 
-  const Vote& vote_;
-  int selected_voter_;
+  const VoteType& vote_;
+  VotingSystem::Strategy strategy_;
+  VotingSystem::Options options_;
+  // Vote of all voters' nixon strategic preferences.
+  VoteType strategic_vote_;
   std::vector<int> strategic_preference_;
-  base::Clock::Diff time_limit_;
+  bool optimal_;
+  base::BudgetScheduler::Report search_report_;
+  // Time spent on preprocessing on the clock of the time limit, summed over
+  // the searching threads, the remainder is left for each query.
+  base::Clock::Diff preprocess_time_;
 };
 
 }  // namespace bush
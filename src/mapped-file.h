@@ -0,0 +1,61 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_MAPPED_FILE_H_
+#define SRC_MAPPED_FILE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstddef>
+#include <string>
+
+namespace base {
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+ public:
+  // Maps the file at given path, the mapping is empty if the file is empty or
+  // could not be mapped.
+  explicit MappedFile(const std::string& path)
+      : data_(nullptr), size_(0) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        // The file is usually scanned once from front to back.
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(data);
+        size_ = st.st_size;
+      }
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_) {
+      munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  const char* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+
+  const char* data_;
+  size_t size_;
+};
+
+}  // namespace base
+#endif  // SRC_MAPPED_FILE_H_
@@ -0,0 +1,59 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./pairwise-matrix.h"
+#include <algorithm>
+#include "./vote.h"
+
+using std::min;
+
+namespace bush {
+
+template<class VoteType>
+PairwiseMatrix::PairwiseMatrix(const VoteType& vote)
+    : num_candidates_(vote.num_candidates()),
+      wins_(num_candidates_ * num_candidates_, 0) {
+  const int num_ballots = vote.num_ballots();
+  // The rating rows of a block of ballots stay in cache while they are added
+  // to the matrix tile by tile, each tile stays in cache for the whole block.
+  for (int b0 = 0; b0 < num_ballots; b0 += kBallotBlockSize) {
+    const int b1 = min(num_ballots, b0 + kBallotBlockSize);
+    for (int i0 = 0; i0 < num_candidates_; i0 += kTileSize) {
+      const int i1 = min(num_candidates_, i0 + kTileSize);
+      for (int j0 = 0; j0 < num_candidates_; j0 += kTileSize) {
+        const int j1 = min(num_candidates_, j0 + kTileSize);
+        for (int b = b0; b < b1; ++b) {
+          const int weight = vote.count(b);
+          if (!weight) {
+            continue;
+          }
+          const typename VoteType::RatingType* ratings =
+              vote.ballot_ratings(b).data();
+          for (int i = i0; i < i1; ++i) {
+            const int rating = ratings[i];
+            int* row = wins_.data() + i * num_candidates_;
+            for (int j = j0; j < j1; ++j) {
+              row[j] += rating > ratings[j] ? weight : 0;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+template<typename Rating>
+void PairwiseMatrix::Add(const Rating* ratings, const int weight) {
+  for (int i = 0; i < num_candidates_; ++i) {
+    const int rating = ratings[i];
+    int* row = wins_.data() + i * num_candidates_;
+    for (int j = 0; j < num_candidates_; ++j) {
+      row[j] += rating > ratings[j] ? weight : 0;
+    }
+  }
+}
+
+template PairwiseMatrix::PairwiseMatrix(const Vote& vote);
+template PairwiseMatrix::PairwiseMatrix(const CompactVote& vote);
+template void PairwiseMatrix::Add(const int* ratings, const int weight);
+template void PairwiseMatrix::Add(const uint16_t* ratings, const int weight);
+
+}  // namespace bush
@@ -0,0 +1,50 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_PAIRWISE_MATRIX_H_
+#define SRC_PAIRWISE_MATRIX_H_
+
+#include <vector>
+
+namespace bush {
+
+// Majority matrix of a vote, the number of voters ranking candidate i above
+// candidate j for all pairs. It is built in a single pass over the rating rows
+// and updated in O(C^2) when a single ballot changes.
+class PairwiseMatrix {
+ public:
+  // Number of candidates per side of the matrix tiles, a tile of ints fills
+  // 16 KiB of the L1 cache.
+  static const int kTileSize = 64;
+  // Number of ballots whose rating rows are swept over each tile.
+  static const int kBallotBlockSize = 256;
+
+  // Initialises the matrix of the vote.
+  template<class VoteType>
+  explicit PairwiseMatrix(const VoteType& vote);
+
+  // Adds the ballot of given ratings with given weight, a negative weight
+  // removes it.
+  template<typename Rating>
+  void Add(const Rating* ratings, const int weight);
+
+  // Returns the number of voters ranking candidate i above candidate j.
+  int wins(const int i, const int j) const {
+    return wins_[i * num_candidates_ + j];
+  }
+
+  // Returns whether a majority ranks candidate i above candidate j.
+  bool beats(const int i, const int j) const {
+    return wins(i, j) > wins(j, i);
+  }
+
+  int num_candidates() const {
+    return num_candidates_;
+  }
+
+ private:
+  int num_candidates_;
+  // Row-major C x C matrix.
+  std::vector<int> wins_;
+};
+
+}  // namespace bush
+#endif  // SRC_PAIRWISE_MATRIX_H_
@@ -0,0 +1,132 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./pairwise-rule.h"
+#include <algorithm>
+#include <limits>
+
+using std::string;
+using std::vector;
+using std::max;
+using std::min;
+using std::numeric_limits;
+
+namespace bush {
+
+// Returns the index of the greatest score, the lowest on ties.
+static int ArgMax(const vector<int>& scores) {
+  return max_element(scores.begin(), scores.end()) - scores.begin();
+}
+
+string CopelandRule::Name() {
+  return "copeland";
+}
+
+vector<int> CopelandRule::Scores(const PairwiseMatrix& matrix) {
+  const int num_candidates = matrix.num_candidates();
+  vector<int> scores(num_candidates, 0);
+  for (int i = 0; i < num_candidates; ++i) {
+    for (int j = i + 1; j < num_candidates; ++j) {
+      const int margin = matrix.wins(i, j) - matrix.wins(j, i);
+      scores[i] += margin > 0 ? 2 : margin == 0;
+      scores[j] += margin < 0 ? 2 : margin == 0;
+    }
+  }
+  return scores;
+}
+
+bool CopelandRule::Wins(const PairwiseMatrix& matrix, const int candidate) {
+  return ArgMax(Scores(matrix)) == candidate;
+}
+
+// Returns the width of the direct path from i to j, the number of voters
+// ranking i above j if they are a majority and 0 otherwise.
+static inline int Width(const PairwiseMatrix& matrix, const int i,
+                        const int j) {
+  return matrix.beats(i, j) ? matrix.wins(i, j) : 0;
+}
+
+// Returns the widths of the widest paths from the candidate to all others,
+// or from all others to the candidate if reverse. Dijkstra's algorithm on the
+// dense graph, in O(C^2).
+static vector<int> WidestPaths(const PairwiseMatrix& matrix,
+                               const int candidate, const bool reverse) {
+  const int num_candidates = matrix.num_candidates();
+  vector<int> widths(num_candidates, 0);
+  vector<char> done(num_candidates, false);
+  widths[candidate] = numeric_limits<int>::max();
+  for (int n = 0; n < num_candidates; ++n) {
+    int u = 0;
+    while (done[u]) {
+      ++u;
+    }
+    for (int c = u + 1; c < num_candidates; ++c) {
+      if (!done[c] && widths[c] > widths[u]) {
+        u = c;
+      }
+    }
+    done[u] = true;
+    for (int c = 0; c < num_candidates; ++c) {
+      if (!done[c]) {
+        const int width = reverse ? Width(matrix, c, u) : Width(matrix, u, c);
+        widths[c] = max(widths[c], min(widths[u], width));
+      }
+    }
+  }
+  widths[candidate] = 0;
+  return widths;
+}
+
+string SchulzeRule::Name() {
+  return "schulze";
+}
+
+vector<int> SchulzeRule::Scores(const PairwiseMatrix& matrix) {
+  const int num_candidates = matrix.num_candidates();
+  // Floyd-Warshall on the widest paths.
+  vector<int> paths(num_candidates * num_candidates, 0);
+  for (int i = 0; i < num_candidates; ++i) {
+    for (int j = 0; j < num_candidates; ++j) {
+      if (i != j) {
+        paths[i * num_candidates + j] = Width(matrix, i, j);
+      }
+    }
+  }
+  for (int k = 0; k < num_candidates; ++k) {
+    const int* k_row = paths.data() + k * num_candidates;
+    for (int i = 0; i < num_candidates; ++i) {
+      int* i_row = paths.data() + i * num_candidates;
+      const int i_k = i_row[k];
+      if (i == k || !i_k) {
+        continue;
+      }
+      for (int j = 0; j < num_candidates; ++j) {
+        i_row[j] = max(i_row[j], min(i_k, k_row[j]));
+      }
+    }
+  }
+  vector<int> scores(num_candidates, 0);
+  for (int i = 0; i < num_candidates; ++i) {
+    for (int j = 0; j < num_candidates; ++j) {
+      scores[i] += i != j && paths[i * num_candidates + j] >=
+                             paths[j * num_candidates + i];
+    }
+  }
+  return scores;
+}
+
+bool SchulzeRule::Wins(const PairwiseMatrix& matrix, const int candidate) {
+  const vector<int> from = WidestPaths(matrix, candidate, false);
+  const vector<int> to = WidestPaths(matrix, candidate, true);
+  const int num_candidates = matrix.num_candidates();
+  bool lower_tie = false;
+  for (int c = 0; c < num_candidates; ++c) {
+    if (from[c] < to[c]) {
+      return false;
+    }
+    lower_tie |= c < candidate && from[c] == to[c];
+  }
+  // A lower candidate tying with the candidate may win too and take
+  // precedence.
+  return !lower_tie || ArgMax(Scores(matrix)) == candidate;
+}
+
+}  // namespace bush
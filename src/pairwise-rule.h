@@ -0,0 +1,38 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_PAIRWISE_RULE_H_
+#define SRC_PAIRWISE_RULE_H_
+
+#include <string>
+#include <vector>
+#include "./pairwise-matrix.h"
+
+namespace bush {
+
+// Condorcet-consistent rules for PairwiseSystem, decided on the majority
+// matrix alone. A rule scores the candidates, the winner has the greatest
+// score, the lowest id on ties. The rule's name selects it on the command
+// line.
+
+// Two points per pairwise majority win and one per tie.
+struct CopelandRule {
+  static std::string Name();
+  // Returns the scores of all candidates in O(C^2).
+  static std::vector<int> Scores(const PairwiseMatrix& matrix);
+  // Returns whether the candidate wins in O(C^2).
+  static bool Wins(const PairwiseMatrix& matrix, const int candidate);
+};
+
+// Schulze method, candidate i beats j if the widest path of majority wins
+// from i to j is wider than the one from j to i. The score is the number of
+// candidates not beating the candidate, the winners score C - 1.
+struct SchulzeRule {
+  static std::string Name();
+  // Returns the scores of all candidates in O(C^3).
+  static std::vector<int> Scores(const PairwiseMatrix& matrix);
+  // Returns whether the candidate wins, in O(C^2) unless a lower candidate
+  // ties with it.
+  static bool Wins(const PairwiseMatrix& matrix, const int candidate);
+};
+
+}  // namespace bush
+#endif  // SRC_PAIRWISE_RULE_H_
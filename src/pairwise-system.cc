@@ -0,0 +1,306 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./pairwise-system.h"
+#include <algorithm>
+#include <utility>
+#include <string>
+#include <vector>
+#include "./vote.h"
+#include "./sampler.h"
+#include "./stats.h"
+#include "./thread-pool.h"
+#include "./trace.h"
+
+using std::string;
+using std::vector;
+using std::pair;
+using std::make_pair;
+using std::max;
+using std::max_element;
+using std::sort;
+using base::Clock;
+using base::Deadline;
+using base::Stats;
+using base::ThreadPool;
+using base::Trace;
+
+namespace bush {
+
+// Returns the winner of the rule on the matrix, the lowest id on ties.
+template<class Rule>
+static int Winner(const PairwiseMatrix& matrix) {
+  Stats::Count(Stats::kFindWinnerCalls);
+  const vector<int> scores = Rule::Scores(matrix);
+  return max_element(scores.begin(), scores.end()) - scores.begin();
+}
+
+// Returns whether the candidate wins under the rule on the matrix.
+template<class Rule>
+static bool Wins(const PairwiseMatrix& matrix, const int candidate) {
+  Stats::Count(Stats::kFindWinnerCalls);
+  return Rule::Wins(matrix, candidate);
+}
+
+// Returns the candidates by increasing number of pairwise majority wins, the
+// lowest id on ties.
+static vector<int> ByStrength(const PairwiseMatrix& matrix) {
+  const int num_candidates = matrix.num_candidates();
+  vector<pair<int, int> > strengths;
+  strengths.reserve(num_candidates);
+  for (int i = 0; i < num_candidates; ++i) {
+    int num_wins = 0;
+    for (int j = 0; j < num_candidates; ++j) {
+      num_wins += matrix.beats(i, j);
+    }
+    strengths.push_back(make_pair(num_wins, i));
+  }
+  sort(strengths.begin(), strengths.end());
+  vector<int> candidates;
+  candidates.reserve(num_candidates);
+  for (auto it = strengths.cbegin(), end = strengths.cend(); it != end;
+       ++it) {
+    candidates.push_back(it->second);
+  }
+  return candidates;
+}
+
+// Sets the preference to the candidate followed by the competitors in given
+// order and the ratings to the preference's ratings.
+static void Boost(const int candidate, const vector<int>& competitors,
+                  vector<int>* pref, vector<int>* ratings) {
+  pref->assign(1, candidate);
+  for (auto it = competitors.cbegin(), end = competitors.cend(); it != end;
+       ++it) {
+    if (*it != candidate) {
+      pref->push_back(*it);
+    }
+  }
+  const int num_candidates = pref->size();
+  for (int i = 0; i < num_candidates; ++i) {
+    (*ratings)[(*pref)[i]] = num_candidates - i - 1;
+  }
+}
+
+template<class Rule, class VoteType>
+PairwiseSystem<Rule, VoteType>::PairwiseSystem(
+    const VoteType& vote, const VotingSystem::Strategy strategy,
+    const VotingSystem::Options& options)
+    : vote_(vote),
+      strategy_(strategy),
+      options_(options),
+      base_matrix_(vote),
+      base_ratings_(Rule::Scores(base_matrix_)),
+      base_winner_(max_element(base_ratings_.begin(), base_ratings_.end()) -
+                   base_ratings_.begin()),
+      strategic_vote_(0, 0),
+      strategic_matrix_(strategic_vote_) {
+  Preprocess();
+}
+
+template<class Rule, class VoteType>
+PairwiseSystem<Rule, VoteType>::PairwiseSystem(
+    const VoteType& vote, const int selected_voter_id,
+    const VotingSystem::Strategy strategy,
+    const VotingSystem::Options& options)
+    : vote_(vote),
+      strategy_(strategy),
+      options_(options),
+      base_matrix_(vote),
+      base_ratings_(Rule::Scores(base_matrix_)),
+      base_winner_(max_element(base_ratings_.begin(), base_ratings_.end()) -
+                   base_ratings_.begin()),
+      strategic_vote_(0, 0),
+      strategic_matrix_(strategic_vote_) {
+  Preprocess();
+  strategic_preference_ = StrategicPreference(selected_voter_id);
+}
+
+template<class Rule, class VoteType>
+void PairwiseSystem<Rule, VoteType>::Preprocess() {
+  if (strategy_ != VotingSystem::kComplete) {
+    return;
+  }
+  Stats::PhaseTimer timer(Stats::kPreprocess);
+  Trace::Span span("pairwise.preprocess");
+  const int num_voters = vote_.num_voters();
+  const int num_ballots = vote_.num_ballots();
+  // Voters sharing a ballot share their strategic preference, it is computed
+  // once per ballot for a representative voter.
+  vector<int> ballot_voters(num_ballots);
+  for (int v = num_voters - 1; v >= 0; --v) {
+    ballot_voters[vote_.voter_ballot(v)] = v;
+  }
+  vector<vector<int> > ballot_prefs(num_ballots);
+  // The ballots share two thirds of the time limit on all threads.
+  const Clock::Diff ballot_time = options_.time_limit * 0.66 *
+                                  options_.num_threads / max(1, num_ballots);
+  ThreadPool pool(options_.num_threads);
+  pool.ParallelFor(0, num_ballots, [&](const int b) {
+    Trace::Span span("pairwise.voter_search", ballot_voters[b]);
+    Deadline deadline(options_.clock_type, ballot_time);
+    ballot_prefs[b] = FindStrategicPreference(vote_, base_matrix_,
+                                              base_winner_, ballot_voters[b],
+                                              &deadline);
+  });
+  strategic_vote_ = VoteType(vote_.num_candidates(), num_voters);
+  vector<int> strategic_ballots(num_ballots);
+  for (int b = 0; b < num_ballots; ++b) {
+    strategic_ballots[b] = strategic_vote_.AddBallot(ballot_prefs[b]);
+  }
+  for (int v = 0; v < num_voters; ++v) {
+    strategic_vote_.AssignBallot(v, strategic_ballots[vote_.voter_ballot(v)]);
+  }
+  strategic_matrix_ = PairwiseMatrix(strategic_vote_);
+}
+
+template<class Rule, class VoteType>
+vector<int> PairwiseSystem<Rule, VoteType>::StrategicPreference(
+    const int selected_voter) const {
+  Stats::PhaseTimer timer(Stats::kSearch);
+  Trace::Span span("pairwise.search", selected_voter);
+  if (strategy_ == VotingSystem::kSimple) {
+    Deadline deadline(options_.clock_type, options_.time_limit);
+    return FindStrategicPreference(vote_, base_matrix_, base_winner_,
+                                   selected_voter, &deadline);
+  } else if (strategy_ == VotingSystem::kComplete) {
+    // The selected voter keeps its sincere preference.
+    PairwiseMatrix matrix = strategic_matrix_;
+    matrix.Add(strategic_vote_.ratings(selected_voter).data(), -1);
+    matrix.Add(vote_.ratings(selected_voter).data(), 1);
+    Deadline deadline(options_.clock_type, options_.time_limit * 0.34);
+    return FindStrategicPreference(vote_, matrix, Winner<Rule>(matrix),
+                                   selected_voter, &deadline);
+  } else if (strategy_ == VotingSystem::kIndependent) {
+    // The utility is measured on the sincere vote.
+    const int utility = Utility(vote_, base_matrix_, selected_voter);
+    const Clock::Diff voter_time =
+        options_.time_limit * 0.1 / vote_.num_voters();
+    const Clock::Type clock_type = options_.clock_type;
+    Sampler<VoteType> sampler(vote_, selected_voter, options_.num_threads,
+                              options_.clock_type, options_.time_limit);
+    return sampler.Run([selected_voter, utility, voter_time, clock_type](
+        const VoteType& sample, const int, int* sample_utility) {
+      *sample_utility = utility;
+      const PairwiseMatrix matrix(sample);
+      Deadline deadline(clock_type, voter_time);
+      return FindStrategicPreference(sample, matrix, Winner<Rule>(matrix),
+                                     selected_voter, &deadline);
+    });
+  }
+  const typename VoteType::Row pref = vote_.preference(selected_voter);
+  return vector<int>(pref.begin(), pref.end());
+}
+
+template<class Rule, class VoteType>
+vector<int> PairwiseSystem<Rule, VoteType>::FindStrategicPreference(
+    const VoteType& vote, const PairwiseMatrix& matrix, const int winner,
+    const int selected_voter, Deadline* deadline) {
+  const int num_candidates = vote.num_candidates();
+  const typename VoteType::Row sincere = vote.preference(selected_voter);
+  const typename VoteType::RatingRow selected_ratings =
+      vote.ratings(selected_voter);
+  vector<int> sincere_pref(sincere.begin(), sincere.end());
+  if (winner == sincere[0]) {
+    return sincere_pref;
+  }
+  // The matrix of the other voters, each tried preference is added and
+  // removed again.
+  PairwiseMatrix others = matrix;
+  others.Add(selected_ratings.data(), -1);
+  // The competitors of the boosted candidate follow by increasing number of
+  // pairwise majority wins, the strongest ones are beaten by all others.
+  const vector<int> competitors = ByStrength(others);
+  vector<int> pref;
+  pref.reserve(num_candidates);
+  vector<int> ratings(num_candidates);
+  // Try the candidates preferred to the sincere winner, best first. The best
+  // one is tried even if the deadline has already expired, the per-sample
+  // deadlines of gandhi may be shorter than the clock resolution.
+  const int sincere_utility = selected_ratings[winner];
+  for (int p = 0; selected_ratings[sincere[p]] > sincere_utility &&
+                  (p == 0 || !deadline->Expired()); ++p) {
+    const int candidate = sincere[p];
+    Boost(candidate, competitors, &pref, &ratings);
+    others.Add(ratings.data(), 1);
+    const bool wins = Wins<Rule>(others, candidate);
+    others.Add(ratings.data(), -1);
+    if (wins) {
+      return pref;
+    }
+  }
+  return sincere_pref;
+}
+
+template<class Rule, class VoteType>
+vector<int> PairwiseSystem<Rule, VoteType>::CoalitionPreference(
+    const Coalition<VoteType>& coalition, Deadline* deadline,
+    int* sincere_winner, int* winner) {
+  Trace::Span span("pairwise.coalition_search", coalition.size());
+  const VoteType& vote = coalition.vote();
+  const int num_candidates = vote.num_candidates();
+  PairwiseMatrix others(vote);
+  *sincere_winner = Winner<Rule>(others);
+  *winner = *sincere_winner;
+  // Remove the coalition from the matrix, once per ballot.
+  const vector<int>& ballots = coalition.ballots();
+  const vector<int>& weights = coalition.weights();
+  const int num_ballots = ballots.size();
+  for (int i = 0; i < num_ballots; ++i) {
+    others.Add(vote.ballot_ratings(ballots[i]).data(), -weights[i]);
+  }
+  const vector<int> competitors = ByStrength(others);
+  const vector<int> targets = coalition.Targets(*sincere_winner);
+  const int weight = coalition.size();
+  vector<int> pref;
+  pref.reserve(num_candidates);
+  vector<int> ratings(num_candidates);
+  // The best target is tried even if the deadline has already expired.
+  for (auto it = targets.cbegin(), end = targets.cend();
+       it != end && (it == targets.cbegin() || !deadline->Expired()); ++it) {
+    Boost(*it, competitors, &pref, &ratings);
+    others.Add(ratings.data(), weight);
+    const bool wins = Wins<Rule>(others, *it);
+    others.Add(ratings.data(), -weight);
+    if (wins) {
+      *winner = *it;
+      return pref;
+    }
+  }
+  // No joint ballot is reported, the voters keep their sincere ballots.
+  return vector<int>();
+}
+
+template<class Rule, class VoteType>
+int PairwiseSystem<Rule, VoteType>::Utility(const VoteType& vote,
+                                            const PairwiseMatrix& matrix,
+                                            const int selected_voter) {
+  Stats::Count(Stats::kUtilityCalls);
+  const typename VoteType::RatingRow selected_ratings =
+      vote.ratings(selected_voter);
+  // Ignore the selected voter.
+  PairwiseMatrix others = matrix;
+  others.Add(selected_ratings.data(), -1);
+  return selected_ratings[Winner<Rule>(others)];
+}
+
+template<class Rule, class VoteType>
+string PairwiseSystem<Rule, VoteType>::Name() {
+  return Rule::Name();
+}
+
+template<class Rule, class VoteType>
+const vector<int>& PairwiseSystem<Rule, VoteType>::base_ratings() const {
+  return base_ratings_;
+}
+
+template<class Rule, class VoteType>
+const vector<int>& PairwiseSystem<Rule, VoteType>::strategic_preference()
+    const {
+  return strategic_preference_;
+}
+
+template class PairwiseSystem<CopelandRule, Vote>;
+template class PairwiseSystem<CopelandRule, CompactVote>;
+template class PairwiseSystem<SchulzeRule, Vote>;
+template class PairwiseSystem<SchulzeRule, CompactVote>;
+
+}  // namespace bush
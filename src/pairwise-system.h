@@ -0,0 +1,82 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_PAIRWISE_SYSTEM_H_
+#define SRC_PAIRWISE_SYSTEM_H_
+
+#include <string>
+#include <vector>
+#include "./coalition.h"
+#include "./pairwise-matrix.h"
+#include "./pairwise-rule.h"
+#include "./voting-system.h"
+#include "./clock.h"
+#include "./deadline.h"
+
+namespace bush {
+
+// Voting system of the pairwise Rule on the majority matrix. The strategic
+// preference puts the most preferred candidate that the voter can make win
+// first and the other candidates by increasing number of pairwise majority
+// wins. Each tried preference updates the matrix in O(C^2), the best candidate
+// is always tried and the others until the deadline expires.
+template<class Rule, class VoteType>
+class PairwiseSystem : public VotingSystem {
+ public:
+  // Returns the name of the voting system.
+  static std::string Name();
+  // Returns the utility for the selected voter given the majority matrix of
+  // all voters, the selected voter's ballot is removed in O(C^2).
+  static int Utility(const VoteType& vote, const PairwiseMatrix& matrix,
+                     const int selected_voter);
+  // Returns the joint preference of the coalition against the sincere other
+  // voters, which puts the best shared target that can win first and the
+  // other candidates by increasing number of pairwise majority wins. Returns
+  // an empty preference if no target wins before the deadline expires, the
+  // coalition's voters then keep their sincere ballots. Sets the sincere
+  // winner and the winner, which is the sincere winner if the preference is
+  // empty.
+  static std::vector<int> CoalitionPreference(
+      const Coalition<VoteType>& coalition, base::Deadline* deadline,
+      int* sincere_winner, int* winner);
+
+  // Precomputes the strategy for queries of any selected voter.
+  PairwiseSystem(const VoteType& vote, const VotingSystem::Strategy strategy,
+                 const VotingSystem::Options& options);
+  // Precomputes the strategy and computes the strategic preference of the
+  // selected voter.
+  PairwiseSystem(const VoteType& vote, const int selected_voter_id,
+                 const VotingSystem::Strategy strategy,
+                 const VotingSystem::Options& options);
+  // Returns the strategic preference of the selected voter.
+  std::vector<int> StrategicPreference(const int selected_voter) const;
+  // Returns the rule's scores of the candidates.
+  const std::vector<int>& base_ratings() const;
+  const std::vector<int>& strategic_preference() const;
+
+ private:
+  void Preprocess();
+  // Returns the strategic preference of the selected voter, given the matrix
+  // of all voters and its winner.
+  static std::vector<int> FindStrategicPreference(
+      const VoteType& vote, const PairwiseMatrix& matrix, const int winner,
+      const int selected_voter, base::Deadline* deadline);
+
+  const VoteType& vote_;
+  VotingSystem::Strategy strategy_;
+  VotingSystem::Options options_;
+  PairwiseMatrix base_matrix_;
+  std::vector<int> base_ratings_;
+  int base_winner_;
+  // Vote of all voters' nixon strategic preferences and its matrix.
+  VoteType strategic_vote_;
+  PairwiseMatrix strategic_matrix_;
+  std::vector<int> strategic_preference_;
+};
+
+template<class VoteType>
+using Copeland = PairwiseSystem<CopelandRule, VoteType>;
+
+template<class VoteType>
+using Schulze = PairwiseSystem<SchulzeRule, VoteType>;
+
+}  // namespace bush
+#endif  // SRC_PAIRWISE_SYSTEM_H_
@@ -1,15 +1,25 @@
 // Copyright 2012 Eugen Sawin <esawin@me73.com>
 #include "./parser.h"
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 #include <fstream>
-#include <sstream>
+#include <limits>
+#include "./binary-format.h"
+#include "./mapped-file.h"
+#include "./thread-pool.h"
+#include "./trace.h"
 
 using std::string;
 using std::ifstream;
-using std::stringstream;
 using std::vector;
-using std::set;
 using std::min;
+using std::max;
+using std::count;
+using std::numeric_limits;
+using base::MappedFile;
+using base::ThreadPool;
+using base::Trace;
 
 namespace bush {
 
@@ -30,52 +40,257 @@ size_t Parser::FileSize(const string& path) {
 
 vector<int> Parser::SplitInts(const string& content) {
   vector<int> items;
-  size_t pos = content.find_first_not_of(kWhitespace);
-  while (pos != string::npos) {
-    size_t end = content.find_first_of(kWhitespace, pos);
-    if (end == string::npos) {
-      // Last item found.
-      items.push_back(Convert<int>(content.substr(pos)));
-    } else {
-      // Item found.
-      items.push_back(Convert<int>(content.substr(pos, end - pos)));
-    }
-    pos = content.find_first_not_of(kWhitespace, end);
+  const char* pos = content.data();
+  const char* end = pos + content.size();
+  int item = 0;
+  while (ScanInt(&pos, end, &item)) {
+    items.push_back(item);
   }
   return items;
 }
 
+bool Parser::ScanInt(const char** pos, const char* end, int* value) {
+  const char* p = *pos;
+  while (p != end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) {
+    ++p;
+  }
+  const bool negative = p != end && *p == '-';
+  if (negative) {
+    ++p;
+  }
+  if (p == end || *p < '0' || *p > '9') {
+    *pos = p;
+    return false;
+  }
+  int v = 0;
+  while (p != end && *p >= '0' && *p <= '9') {
+    const int digit = *p - '0';
+    if (v > (numeric_limits<int>::max() - digit) / 10) {
+      // Overflow, the digit is left unconsumed.
+      *pos = p;
+      return false;
+    }
+    v = v * 10 + digit;
+    ++p;
+  }
+  *value = negative ? -v : v;
+  *pos = p;
+  return true;
+}
+
+// Returns the number of lines in [beg, end), a last line without line break
+// included.
+static int CountLines(const char* beg, const char* end) {
+  const int num_breaks = count(beg, end, '\n');
+  return num_breaks + (beg != end && *(end - 1) != '\n');
+}
+
 Parser::Parser(const string& path)
-    : path_(path) {}
-
-Vote Parser::ParseVote() {
-  if (content_.size() == 0) {
-    ReadAll();
-  }
-  assert(content_.size());
-  size_t pos = content_.find("\n");
-  assert(pos != string::npos);
-  vector<int> header = SplitInts(content_.substr(0, pos));
-  assert(header.size() == 2);
-  Vote vote(header[0], header[1]);
-  for (int i = 0; i < vote.num_voters(); ++i) {
-    size_t end = content_.find("\n", pos + 1);
-    assert(end != string::npos);
-    vote.AddPreference(i, SplitInts(content_.substr(pos, end - pos)));
-    pos = end;
+    : path_(path),
+      num_threads_(1) {}
+
+Parser::Parser(const string& path, const int num_threads)
+    : path_(path),
+      num_threads_(num_threads) {}
+
+template<class VoteType>
+VoteType Parser::ParseVote() {
+  error_.clear();
+  const MappedFile file(path_);
+  Error error;
+  if (!file.size()) {
+    error.message = "file is empty or does not exist";
+    SetError(error);
+    return VoteType(0, 0);
+  }
+  const char* beg = file.data();
+  const char* end = beg + file.size();
+  if (BinaryFormat::IsBinary(beg, file.size())) {
+    VoteType vote = BinaryFormat::Read<VoteType>(beg, file.size(),
+                                                 &error.message);
+    if (!error.message.empty()) {
+      SetError(error);
+    }
+    return vote;
+  }
+  const char* header_end = static_cast<const char*>(memchr(beg, '\n',
+                                                           end - beg));
+  const char* body = header_end ? header_end + 1 : end;
+  const char* pos = beg;
+  int num_candidates = 0;
+  int num_voters = 0;
+  int extra = 0;
+  if (!ScanInt(&pos, body, &num_candidates) ||
+      !ScanInt(&pos, body, &num_voters) ||
+      ScanInt(&pos, body, &extra) || pos != body ||
+      num_candidates < 1 || num_voters < 0) {
+    error.line = 1;
+    error.message = "expected header <num candidates> <num voters>";
+    SetError(error);
+    return VoteType(0, 0);
+  } else if (num_candidates > VoteType::MaxCandidates()) {
+    error.line = 1;
+    error.message = "too many candidates";
+    SetError(error);
+    return VoteType(0, 0);
+  } else if (num_voters > VoteType::MaxVoters(num_candidates)) {
+    error.line = 1;
+    error.message = "too many voters for " + Convert<string>(num_candidates) +
+                    " candidates";
+    SetError(error);
+    return VoteType(0, 0);
+  }
+
+  // Cut the body into chunks at line boundaries.
+  const size_t body_size = end - body;
+  const int num_chunks = max(1, min(num_threads_,
+                                    static_cast<int>(body_size /
+                                                     kMinChunkSize)));
+  vector<const char*> bounds(num_chunks + 1, end);
+  bounds[0] = body;
+  for (int i = 1; i < num_chunks; ++i) {
+    const char* cut = max(bounds[i - 1], body + body_size * i / num_chunks);
+    const char* eol = static_cast<const char*>(memchr(cut, '\n', end - cut));
+    bounds[i] = eol ? eol + 1 : end;
+  }
+  // Count the lines per chunk to find the first voter of each chunk.
+  ThreadPool pool(num_threads_);
+  vector<int> first_voters(num_chunks + 1, 0);
+  pool.ParallelFor(0, num_chunks, [&bounds, &first_voters](const int i) {
+    Trace::Span span("parse.count_lines", i);
+    first_voters[i + 1] = CountLines(bounds[i], bounds[i + 1]);
+  });
+  for (int i = 0; i < num_chunks; ++i) {
+    first_voters[i + 1] += first_voters[i];
+  }
+  if (first_voters[num_chunks] < num_voters) {
+    error.line = first_voters[num_chunks] + 2;
+    error.message = "expected " + Convert<string>(num_voters) +
+                    " preferences, found " +
+                    Convert<string>(first_voters[num_chunks]);
+    SetError(error);
+    return VoteType(0, 0);
+  }
+
+  // Parse the chunks into partial votes.
+  vector<VoteType> parts;
+  parts.reserve(num_chunks);
+  for (int i = 0; i < num_chunks; ++i) {
+    const int part_voters = max(0, min(num_voters, first_voters[i + 1]) -
+                                   first_voters[i]);
+    parts.push_back(VoteType(num_candidates, part_voters));
+  }
+  vector<Error> errors(num_chunks);
+  vector<char> valid(num_chunks, false);
+  pool.ParallelFor(0, num_chunks, [&](const int i) {
+    Trace::Span span("parse.chunk", i);
+    valid[i] = ParseChunk(bounds[i], bounds[i + 1], first_voters[i],
+                          num_voters, &parts[i], &errors[i]);
+  });
+  for (int i = 0; i < num_chunks; ++i) {
+    if (!valid[i]) {
+      // Report the first malformed line.
+      SetError(errors[i]);
+      return VoteType(0, 0);
+    }
+  }
+
+  // Merge the partial votes into their final voter slots.
+  VoteType vote(num_candidates, num_voters);
+  for (int i = 0; i < num_chunks; ++i) {
+    vote.AddVote(first_voters[i], parts[i]);
   }
   return vote;
 }
 
-void Parser::ReadAll() {
-  size_t file_size = FileSize(path_);
-  char* buffer = new char[file_size + 1];
-  buffer[file_size] = '\0';
-  ifstream stream(path_);
-  assert(stream.good());
-  stream.read(buffer, file_size);
-  assert(static_cast<size_t>(stream.gcount()) == file_size);
-  content_ = string(buffer);
+int Parser::NumCandidates() const {
+  const MappedFile file(path_);
+  if (!file.size()) {
+    return 0;
+  }
+  const char* pos = file.data();
+  const char* end = pos + file.size();
+  if (BinaryFormat::IsBinary(pos, file.size())) {
+    return BinaryFormat::NumCandidates(pos, file.size());
+  }
+  const char* header_end = static_cast<const char*>(memchr(pos, '\n',
+                                                           end - pos));
+  int num_candidates = 0;
+  if (!ScanInt(&pos, header_end ? header_end : end, &num_candidates)) {
+    return 0;
+  }
+  return max(0, num_candidates);
+}
+
+const string& Parser::error() const {
+  return error_;
 }
 
+template<class VoteType>
+bool Parser::ParseChunk(const char* beg, const char* end,
+                        const int first_voter, const int num_voters,
+                        VoteType* part, Error* error) const {
+  const int num_candidates = part->num_candidates();
+  vector<int> pref(num_candidates);
+  // Voter stamps per candidate, used to detect repeated candidates.
+  vector<int> seen(num_candidates, -1);
+  int voter = first_voter;
+  const char* line = beg;
+  while (line != end) {
+    const char* eol = static_cast<const char*>(memchr(line, '\n', end - line));
+    if (!eol) {
+      eol = end;
+    }
+    const char* pos = line;
+    int value = 0;
+    error->line = voter + 2;
+    if (voter >= num_voters) {
+      if (ScanInt(&pos, eol, &value) || pos != eol) {
+        error->message = "expected " + Convert<string>(num_voters) +
+                         " preferences, found more";
+        return false;
+      }
+    } else {
+      for (int c = 0; c < num_candidates; ++c) {
+        if (!ScanInt(&pos, eol, &value)) {
+          error->message = pos != eol ?
+                           "invalid candidate id" :
+                           "expected " + Convert<string>(num_candidates) +
+                           " candidates, found " + Convert<string>(c);
+          return false;
+        } else if (value < 0 || value >= num_candidates) {
+          error->message = "candidate id " + Convert<string>(value) +
+                           " out of range";
+          return false;
+        } else if (seen[value] == voter) {
+          error->message = "repeated candidate id " + Convert<string>(value);
+          return false;
+        }
+        seen[value] = voter;
+        pref[c] = value;
+      }
+      if (ScanInt(&pos, eol, &value) || pos != eol) {
+        error->message = "expected " + Convert<string>(num_candidates) +
+                         " candidates, found more";
+        return false;
+      }
+      part->AddPreference(voter - first_voter, pref);
+    }
+    ++voter;
+    line = eol == end ? end : eol + 1;
+  }
+  return true;
+}
+
+void Parser::SetError(const Error& error) {
+  error_ = path_ + ":";
+  if (error.line) {
+    error_ += Convert<string>(error.line) + ":";
+  }
+  error_ += " " + error.message;
+}
+
+template Vote Parser::ParseVote<Vote>();
+template CompactVote Parser::ParseVote<CompactVote>();
+
 }  // namespace bush
@@ -5,6 +5,7 @@
 #include <vector>
 #include <set>
 #include <string>
+#include <sstream>
 #include "./vote.h"
 
 namespace bush {
@@ -13,6 +14,8 @@ class Parser {
  public:
   static const char* kNumbers;
   static const char* kWhitespace;
+  // Minimum number of bytes per parsing thread.
+  static const size_t kMinChunkSize = 1 << 20;
 
   // Converts a value from one type to another.
   template<typename To, typename From>
@@ -30,18 +33,53 @@ class Parser {
   // Splits the given string at whitespaces and converts elements to int.
   static std::vector<int> SplitInts(const std::string& content);
 
+  // Scans the next whitespace-separated integer in [pos, end) and advances
+  // pos past it. Returns false if no integer is found before end or if it
+  // overflows int, pos is then left at the offending character.
+  static bool ScanInt(const char** pos, const char* end, int* value);
+
   // Initialised the parser with given path.
   explicit Parser(const std::string& path);
 
-  // Parses a vote file and returns its representative data structure.
-  Vote ParseVote();
+  // Initialised the parser with given path and number of parsing threads.
+  Parser(const std::string& path, const int num_threads);
+
+  // Parses a vote file and returns its representative data structure,
+  // identical preferences are collapsed into weighted ballots. The file is
+  // memory-mapped and its body is cut into chunks at line boundaries, which
+  // are parsed in parallel. Files in the binary format are read in place
+  // without parsing. Returns an empty vote and sets the error message if the
+  // file is malformed or has more candidates than VoteType can represent.
+  template<class VoteType>
+  VoteType ParseVote();
+
+  // Returns the number of candidates given in the file's header without
+  // parsing the preferences, 0 if the file is empty or the header malformed.
+  // Used to choose the narrowest vote type before parsing.
+  int NumCandidates() const;
+
+  // Returns the error message of the last parse, empty on success.
+  const std::string& error() const;
 
  private:
-  // Reads the whole file into parser cache.
-  void ReadAll();
+  // Parse error of a chunk.
+  struct Error {
+    Error() : line(0) {}
+    int line;
+    std::string message;
+  };
+
+  // Parses the preference lines in [beg, end) into the partial vote, the
+  // first line belongs to given voter. Returns false and sets the error for
+  // the first malformed line.
+  template<class VoteType>
+  bool ParseChunk(const char* beg, const char* end, const int first_voter,
+                  const int num_voters, VoteType* part, Error* error) const;
+  void SetError(const Error& error);
 
   std::string path_;
-  std::string content_;
+  int num_threads_;
+  std::string error_;
 };
 
 }  // namespace bush
@@ -0,0 +1,151 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_PERMUTATION_SET_H_
+#define SRC_PERMUTATION_SET_H_
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace base {
+
+// Set of permutations of [0, n) stored as fixed-width keys instead of
+// vectors. Permutations of up to kMaxRankSize elements are keyed by their
+// exact Lehmer rank, larger ones by a 64-bit fingerprint, whose collisions
+// are improbable enough to be ignored. For up to kMaxBitsetSize elements the
+// set is a bitset over all n! ranks, otherwise an open-addressing hash table.
+class PermutationSet {
+ public:
+  // Largest n with n! < 2^64.
+  static const int kMaxRankSize = 20;
+  // Largest n for the bitset, 8! bits are 5 KiB.
+  static const int kMaxBitsetSize = 8;
+  static const size_t kMinSlots = 64;
+
+  // Returns the Lehmer rank of the permutation in [0, n!).
+  static uint64_t Rank(const std::vector<int>& perm) {
+    const int size = perm.size();
+    assert(size <= kMaxRankSize);
+    uint32_t unused = (uint32_t(1) << size) - 1;
+    uint64_t rank = 0;
+    for (int i = 0; i < size; ++i) {
+      const uint32_t bit = uint32_t(1) << perm[i];
+      assert(unused & bit);
+      // Mixed radix digit, the number of smaller elements not used yet.
+      rank = rank * (size - i) + __builtin_popcount(unused & (bit - 1));
+      unused &= ~bit;
+    }
+    return rank;
+  }
+
+  // Returns the 64-bit fingerprint of the sequence.
+  static uint64_t Fingerprint(const std::vector<int>& seq) {
+    uint64_t h = seq.size();
+    for (auto it = seq.cbegin(), end = seq.cend(); it != end; ++it) {
+      h = Mix(h ^ static_cast<uint32_t>(*it));
+    }
+    return h;
+  }
+
+  explicit PermutationSet(const int size)
+      : size_(size),
+        num_elements_(0) {
+    Clear();
+  }
+
+  // Inserts the permutation, returns whether it was not contained before.
+  bool Insert(const std::vector<int>& perm) {
+    assert(static_cast<int>(perm.size()) == size_);
+    if (size_ <= kMaxBitsetSize) {
+      const uint64_t rank = Rank(perm);
+      uint64_t& word = bits_[rank >> 6];
+      const uint64_t bit = uint64_t(1) << (rank & 63);
+      if (word & bit) {
+        return false;
+      }
+      word |= bit;
+      return true;
+    }
+    if (2 * (num_elements_ + 1) > slots_.size()) {
+      Rehash(2 * slots_.size());
+    }
+    const uint64_t key = Key(perm);
+    uint64_t& slot = slots_[Find(key)];
+    if (slot == key) {
+      return false;
+    }
+    slot = key;
+    ++num_elements_;
+    return true;
+  }
+
+  // Removes all permutations.
+  void Clear() {
+    num_elements_ = 0;
+    if (size_ <= kMaxBitsetSize) {
+      uint64_t num_perms = 1;
+      for (int i = 2; i <= size_; ++i) {
+        num_perms *= i;
+      }
+      bits_.assign((num_perms + 63) / 64, 0);
+    } else {
+      slots_.assign(kMinSlots, static_cast<uint64_t>(kEmpty));
+    }
+  }
+
+ private:
+  static const uint64_t kEmpty = 0;
+
+  // Returns the mixed bits of the value (splitmix64 finalizer).
+  static uint64_t Mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+
+  // Returns the non-empty key of the permutation.
+  uint64_t Key(const std::vector<int>& perm) const {
+    if (size_ <= kMaxRankSize) {
+      // Ranks are below 20! < 2^63, the increment does not overflow.
+      return Rank(perm) + 1;
+    }
+    const uint64_t fingerprint = Fingerprint(perm);
+    return fingerprint == kEmpty ? 1 : fingerprint;
+  }
+
+  // Returns the slot of the key or the empty slot it belongs into.
+  size_t Find(const uint64_t key) const {
+    const size_t mask = slots_.size() - 1;
+    size_t i = Mix(key) & mask;
+    while (slots_[i] != kEmpty && slots_[i] != key) {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  void Rehash(const size_t num_slots) {
+    std::vector<uint64_t> slots(num_slots, static_cast<uint64_t>(kEmpty));
+    slots.swap(slots_);
+    for (auto it = slots.cbegin(), end = slots.cend(); it != end; ++it) {
+      if (*it != kEmpty) {
+        slots_[Find(*it)] = *it;
+      }
+    }
+  }
+
+  int size_;
+  // Number of permutations contained, bounds the load factor of the table.
+  size_t num_elements_;
+  std::vector<uint64_t> bits_;
+  std::vector<uint64_t> slots_;
+};
+
+// Hash functor for permutations and other int sequences in unordered
+// containers, based on the 64-bit fingerprint.
+struct PermutationHash {
+  size_t operator()(const std::vector<int>& seq) const {
+    return PermutationSet::Fingerprint(seq);
+  }
+};
+
+}  // namespace base
+#endif  // SRC_PERMUTATION_SET_H_
@@ -0,0 +1,102 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./profile-generator.h"
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include "./vote.h"
+
+using std::vector;
+using std::min;
+using std::swap;
+using std::pow;
+
+namespace bush {
+
+template<class VoteType>
+ProfileGenerator<VoteType>::ProfileGenerator(const uint32_t seed)
+    : random_(seed) {}
+
+template<class VoteType>
+VoteType ProfileGenerator<VoteType>::ImpartialCulture(const int num_candidates,
+                                                      const int num_voters) {
+  VoteType vote(num_candidates, num_voters);
+  for (int v = 0; v < num_voters; ++v) {
+    vote.AddPreference(v, Permutation(num_candidates));
+  }
+  return vote;
+}
+
+template<class VoteType>
+VoteType ProfileGenerator<VoteType>::Mallows(const int num_candidates,
+                                             const int num_voters,
+                                             const double phi) {
+  assert(phi >= 0.0 && phi <= 1.0);
+  // Repeated insertion, candidate i is inserted j positions above its
+  // reference position with probability proportional to phi^j.
+  vector<vector<double> > insert_probs(num_candidates);
+  for (int i = 0; i < num_candidates; ++i) {
+    double sum = 0.0;
+    for (int j = 0; j <= i; ++j) {
+      sum += pow(phi, j);
+    }
+    for (int j = 0; j <= i; ++j) {
+      insert_probs[i].push_back(pow(phi, j) / sum);
+    }
+  }
+  VoteType vote(num_candidates, num_voters);
+  vector<int> pref;
+  for (int v = 0; v < num_voters; ++v) {
+    pref.clear();
+    for (int i = 0; i < num_candidates; ++i) {
+      double r = random_.Next();
+      int j = 0;
+      while (j < i && r >= insert_probs[i][j]) {
+        r -= insert_probs[i][j];
+        ++j;
+      }
+      pref.insert(pref.end() - j, i);
+    }
+    vote.AddPreference(v, pref);
+  }
+  return vote;
+}
+
+template<class VoteType>
+VoteType ProfileGenerator<VoteType>::Urn(const int num_candidates,
+                                         const int num_voters,
+                                         const double alpha) {
+  assert(alpha >= 0.0);
+  VoteType vote(num_candidates, num_voters);
+  for (int v = 0; v < num_voters; ++v) {
+    // After v draws the urn holds n! (1 + alpha v) preferences, n! of them
+    // are the initial permutations and the rest copies of the drawn ones.
+    if (random_.Next() * (1.0 + alpha * v) < 1.0) {
+      vote.AddPreference(v, Permutation(num_candidates));
+    } else {
+      vote.AssignBallot(v, vote.voter_ballot(Uniform(v)));
+    }
+  }
+  return vote;
+}
+
+template<class VoteType>
+int ProfileGenerator<VoteType>::Uniform(const int n) {
+  return min(static_cast<int>(random_.Next() * n), n - 1);
+}
+
+template<class VoteType>
+vector<int> ProfileGenerator<VoteType>::Permutation(const int num_candidates) {
+  vector<int> perm(num_candidates);
+  for (int c = 0; c < num_candidates; ++c) {
+    perm[c] = c;
+  }
+  for (int c = num_candidates - 1; c > 0; --c) {
+    swap(perm[c], perm[Uniform(c + 1)]);
+  }
+  return perm;
+}
+
+template class ProfileGenerator<Vote>;
+template class ProfileGenerator<CompactVote>;
+
+}  // namespace bush
@@ -0,0 +1,43 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_PROFILE_GENERATOR_H_
+#define SRC_PROFILE_GENERATOR_H_
+
+#include <cstdint>
+#include <vector>
+#include "./random.h"
+
+namespace bush {
+
+// Seeded generator of synthetic preference profiles, equal seeds generate
+// equal profiles.
+template<class VoteType>
+class ProfileGenerator {
+ public:
+  explicit ProfileGenerator(const uint32_t seed);
+
+  // Returns the impartial culture profile, each preference is a uniformly
+  // random permutation of the candidates.
+  VoteType ImpartialCulture(const int num_candidates, const int num_voters);
+  // Returns the Mallows profile around the reference order of increasing
+  // candidate ids. The probability of a preference decreases by the factor
+  // phi per pairwise disagreement with the reference, phi 0 generates only
+  // the reference and phi 1 is the impartial culture.
+  VoteType Mallows(const int num_candidates, const int num_voters,
+                   const double phi);
+  // Returns the Pólya-Eggenberger urn profile. The urn starts with every
+  // permutation once and each drawn preference is returned with alpha times
+  // the number of permutations copies, alpha 0 is the impartial culture.
+  VoteType Urn(const int num_candidates, const int num_voters,
+               const double alpha);
+
+ private:
+  // Returns a uniformly random integer in [0, n).
+  int Uniform(const int n);
+  // Returns a uniformly random permutation of the candidates.
+  std::vector<int> Permutation(const int num_candidates);
+
+  base::RandomGenerator<double> random_;
+};
+
+}  // namespace bush
+#endif  // SRC_PROFILE_GENERATOR_H_
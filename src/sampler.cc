@@ -0,0 +1,132 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./sampler.h"
+#include <algorithm>
+#include <map>
+#include "./stats.h"
+#include "./thread-pool.h"
+#include "./trace.h"
+#include "./vote.h"
+
+using std::vector;
+using std::map;
+using std::mutex;
+using std::lock_guard;
+using std::swap;
+using std::make_pair;
+using base::Clock;
+using base::Deadline;
+using base::RandomGenerator;
+using base::Stats;
+using base::ThreadPool;
+using base::Trace;
+
+namespace bush {
+
+template<class VoteType>
+const uint32_t Sampler<VoteType>::kSeed;
+
+template<class VoteType>
+Sampler<VoteType>::Sampler(const VoteType& vote, const int selected_voter,
+                           const int num_threads,
+                           const Clock::Type clock_type,
+                           const Clock::Diff time_limit)
+    : vote_(vote),
+      selected_voter_(selected_voter),
+      num_threads_(num_threads),
+      clock_type_(clock_type),
+      time_limit_(time_limit),
+      max_checked_hits_(vote.num_candidates() * vote.num_voters() *
+                        (vote.num_candidates() / 3)),
+      checked_hits_(0),
+      num_samples_(0),
+      known_(vote.num_candidates()) {}
+
+template<class VoteType>
+vector<int> Sampler<VoteType>::Run(const Evaluation& evaluate) {
+  checked_hits_ = 0;
+  num_samples_ = 0;
+  known_.Clear();
+  vector<PrefMap> pref_maps(num_threads_);
+  ThreadPool pool(num_threads_);
+  pool.ParallelFor(0, num_threads_, [&](const int t) {
+    Trace::Span span("sampler.thread", t);
+    Sample(t, evaluate, &pref_maps[t]);
+  });
+  // Merge the thread-local maps in order, to break ties deterministically.
+  map<vector<int>, int> merged;
+  for (auto it = pref_maps.cbegin(), end = pref_maps.cend(); it != end; ++it) {
+    for (auto it2 = it->cbegin(), end2 = it->cend(); it2 != end2; ++it2) {
+      merged[it2->first] += it2->second;
+    }
+  }
+  const typename VoteType::Row sincere = vote_.preference(selected_voter_);
+  vector<int> strategic_preference(sincere.begin(), sincere.end());
+  int best_utility = 0;
+  for (auto it = merged.cbegin(), end = merged.cend(); it != end; ++it) {
+    if (it->second > best_utility) {
+      strategic_preference = it->first;
+      best_utility = it->second;
+    }
+  }
+  return strategic_preference;
+}
+
+template<class VoteType>
+int Sampler<VoteType>::num_samples() const {
+  return num_samples_;
+}
+
+template<class VoteType>
+void Sampler<VoteType>::Sample(const int thread_id,
+                               const Evaluation& evaluate, PrefMap* pref_map) {
+  RandomGenerator<float> random(kSeed + thread_id);
+  const int num_voters = vote_.num_voters();
+  const int num_candidates = vote_.num_candidates();
+  const int rand_candidates = num_candidates / 3;
+  Deadline deadline(clock_type_, time_limit_);
+  while (checked_hits_ < max_checked_hits_ && !deadline.Expired()) {
+    VoteType sample(num_candidates, num_voters);
+    sample.AddPreference(selected_voter_, vote_.preference(selected_voter_));
+    for (int v = 0; v < num_voters; ++v) {
+      if (v == selected_voter_) {
+        continue;
+      }
+      const typename VoteType::Row row = vote_.preference(v);
+      vector<int> voter_pref(row.begin(), row.end());
+      for (int r = 0; r < rand_candidates; ++r) {
+        swap(voter_pref[random.Next() * num_candidates],
+             voter_pref[random.Next() * num_candidates]);
+      }
+      sample.AddPreference(v, voter_pref);
+    }
+    int utility = 0;
+    vector<int> preference = evaluate(sample, thread_id, &utility);
+    ++num_samples_;
+    Stats::Count(Stats::kSamples);
+    auto find = pref_map->find(preference);
+    if (find == pref_map->end()) {
+      if (Register(preference)) {
+        Stats::Count(Stats::kDistinctSamples);
+        checked_hits_ = 0;
+      } else {
+        // Already found by another thread.
+        ++checked_hits_;
+      }
+      pref_map->insert(make_pair(preference, utility));
+    } else {
+      ++checked_hits_;
+      find->second += utility;
+    }
+  }
+}
+
+template<class VoteType>
+bool Sampler<VoteType>::Register(const vector<int>& preference) {
+  lock_guard<mutex> lock(known_mutex_);
+  return known_.Insert(preference);
+}
+
+template class Sampler<Vote>;
+template class Sampler<CompactVote>;
+
+}  // namespace bush
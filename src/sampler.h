@@ -0,0 +1,70 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_SAMPLER_H_
+#define SRC_SAMPLER_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "./clock.h"
+#include "./deadline.h"
+#include "./permutation-set.h"
+#include "./random.h"
+
+namespace bush {
+
+// Parallel Monte Carlo sampler used by the gandhi strategy. Each sample
+// perturbs the preferences of all voters but the selected one by random
+// swaps and evaluates the selected voter's strategic preference for it. The
+// preference with the greatest accumulated utility over all samples wins.
+template<class VoteType>
+class Sampler {
+ public:
+  // Returns the strategic preference for the given sampled vote and sets its
+  // utility, the id of the calling thread may be used to select thread-local
+  // evaluation state.
+  typedef std::function<std::vector<int>(const VoteType& sample,
+                                         const int thread_id,
+                                         int* utility)> Evaluation;
+
+  // Seed of the first thread's random stream, thread t uses kSeed + t.
+  static const uint32_t kSeed = 13;
+
+  // Initialises the sampler with the time limit of each sampling thread,
+  // measured on the given clock.
+  Sampler(const VoteType& vote, const int selected_voter, const int num_threads,
+          const base::Clock::Type clock_type,
+          const base::Clock::Diff time_limit);
+
+  // Samples until no new preferences are found for a number of samples or the
+  // time limit is reached and returns the best preference found.
+  std::vector<int> Run(const Evaluation& evaluate);
+
+  // Returns the number of samples drawn by the last run.
+  int num_samples() const;
+
+ private:
+  typedef std::unordered_map<std::vector<int>, int,
+                             base::PermutationHash> PrefMap;
+
+  // Draws samples on the calling thread into its local preference map.
+  void Sample(const int thread_id, const Evaluation& evaluate,
+              PrefMap* pref_map);
+  // Returns whether the preference is globally new and registers it.
+  bool Register(const std::vector<int>& preference);
+
+  const VoteType& vote_;
+  int selected_voter_;
+  int num_threads_;
+  base::Clock::Type clock_type_;
+  base::Clock::Diff time_limit_;
+  int max_checked_hits_;
+  std::atomic<int> checked_hits_;
+  std::atomic<int> num_samples_;
+  base::PermutationSet known_;
+  std::mutex known_mutex_;
+};
+
+}  // namespace bush
+#endif  // SRC_SAMPLER_H_
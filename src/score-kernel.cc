@@ -0,0 +1,193 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./score-kernel.h"
+#include <cassert>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BUSH_X86_KERNELS_
+#include <immintrin.h>
+#endif
+
+namespace bush {
+
+// Returns the instruction set currently used by the kernels.
+static ScoreKernel::Isa& CurrentIsa() {
+  static ScoreKernel::Isa isa = ScoreKernel::DetectIsa();
+  return isa;
+}
+
+template<typename Row, typename Score>
+static void AccumulateScalar(const Row* row, const Score weight,
+                             const int size, Score* scores) {
+  for (int c = 0; c < size; ++c) {
+    // Unsigned arithmetic, the product may not fit into an int.
+    scores[c] += static_cast<Score>(static_cast<uint32_t>(weight) *
+                                    static_cast<uint32_t>(row[c]));
+  }
+}
+
+#ifdef BUSH_X86_KERNELS_
+__attribute__((target("avx2")))
+static void AccumulateAvx2(const uint16_t* row, const uint16_t weight,
+                           const int size, uint16_t* scores) {
+  const __m256i w = _mm256_set1_epi16(static_cast<int16_t>(weight));
+  int c = 0;
+  for (; c + 16 <= size; c += 16) {
+    const __m256i r = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(row + c));
+    __m256i* s = reinterpret_cast<__m256i*>(scores + c);
+    _mm256_storeu_si256(s, _mm256_add_epi16(_mm256_loadu_si256(s),
+                                            _mm256_mullo_epi16(r, w)));
+  }
+  AccumulateScalar(row + c, weight, size - c, scores + c);
+}
+
+__attribute__((target("avx2")))
+static void AccumulateAvx2(const uint16_t* row, const uint32_t weight,
+                           const int size, uint32_t* scores) {
+  const __m256i w = _mm256_set1_epi32(static_cast<int32_t>(weight));
+  int c = 0;
+  for (; c + 8 <= size; c += 8) {
+    const __m256i r = _mm256_cvtepu16_epi32(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(row + c)));
+    __m256i* s = reinterpret_cast<__m256i*>(scores + c);
+    _mm256_storeu_si256(s, _mm256_add_epi32(_mm256_loadu_si256(s),
+                                            _mm256_mullo_epi32(r, w)));
+  }
+  AccumulateScalar(row + c, weight, size - c, scores + c);
+}
+
+__attribute__((target("avx2")))
+static void AccumulateAvx2(const int* row, const uint32_t weight,
+                           const int size, uint32_t* scores) {
+  const __m256i w = _mm256_set1_epi32(static_cast<int32_t>(weight));
+  int c = 0;
+  for (; c + 8 <= size; c += 8) {
+    const __m256i r = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(row + c));
+    __m256i* s = reinterpret_cast<__m256i*>(scores + c);
+    _mm256_storeu_si256(s, _mm256_add_epi32(_mm256_loadu_si256(s),
+                                            _mm256_mullo_epi32(r, w)));
+  }
+  AccumulateScalar(row + c, weight, size - c, scores + c);
+}
+
+__attribute__((target("sse4.1")))
+static void AccumulateSse4(const uint16_t* row, const uint16_t weight,
+                           const int size, uint16_t* scores) {
+  const __m128i w = _mm_set1_epi16(static_cast<int16_t>(weight));
+  int c = 0;
+  for (; c + 8 <= size; c += 8) {
+    const __m128i r = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(row + c));
+    __m128i* s = reinterpret_cast<__m128i*>(scores + c);
+    _mm_storeu_si128(s, _mm_add_epi16(_mm_loadu_si128(s),
+                                      _mm_mullo_epi16(r, w)));
+  }
+  AccumulateScalar(row + c, weight, size - c, scores + c);
+}
+
+__attribute__((target("sse4.1")))
+static void AccumulateSse4(const uint16_t* row, const uint32_t weight,
+                           const int size, uint32_t* scores) {
+  const __m128i w = _mm_set1_epi32(static_cast<int32_t>(weight));
+  int c = 0;
+  for (; c + 4 <= size; c += 4) {
+    const __m128i r = _mm_cvtepu16_epi32(_mm_loadl_epi64(
+        reinterpret_cast<const __m128i*>(row + c)));
+    __m128i* s = reinterpret_cast<__m128i*>(scores + c);
+    _mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s),
+                                      _mm_mullo_epi32(r, w)));
+  }
+  AccumulateScalar(row + c, weight, size - c, scores + c);
+}
+
+__attribute__((target("sse4.1")))
+static void AccumulateSse4(const int* row, const uint32_t weight,
+                           const int size, uint32_t* scores) {
+  const __m128i w = _mm_set1_epi32(static_cast<int32_t>(weight));
+  int c = 0;
+  for (; c + 4 <= size; c += 4) {
+    const __m128i r = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(row + c));
+    __m128i* s = reinterpret_cast<__m128i*>(scores + c);
+    _mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s),
+                                      _mm_mullo_epi32(r, w)));
+  }
+  AccumulateScalar(row + c, weight, size - c, scores + c);
+}
+#endif  // BUSH_X86_KERNELS_
+
+ScoreKernel::Isa ScoreKernel::isa() {
+  return CurrentIsa();
+}
+
+void ScoreKernel::set_isa(const Isa isa) {
+  assert(isa <= DetectIsa());
+  CurrentIsa() = isa;
+}
+
+ScoreKernel::Isa ScoreKernel::DetectIsa() {
+#ifdef BUSH_X86_KERNELS_
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return kAvx2;
+  } else if (__builtin_cpu_supports("sse4.1")) {
+    return kSse4;
+  }
+#endif
+  return kScalar;
+}
+
+const char* ScoreKernel::IsaName(const Isa isa) {
+  static const char* kNames[] = {"scalar", "sse4", "avx2"};
+  return kNames[isa];
+}
+
+void ScoreKernel::Accumulate(const uint16_t* row, const uint16_t weight,
+                             const int size, uint16_t* scores) {
+#ifdef BUSH_X86_KERNELS_
+  if (isa() == kAvx2) {
+    AccumulateAvx2(row, weight, size, scores);
+    return;
+  } else if (isa() == kSse4) {
+    AccumulateSse4(row, weight, size, scores);
+    return;
+  }
+#endif
+  AccumulateScalar(row, weight, size, scores);
+}
+
+void ScoreKernel::Accumulate(const uint16_t* row, const uint32_t weight,
+                             const int size, uint32_t* scores) {
+#ifdef BUSH_X86_KERNELS_
+  if (isa() == kAvx2) {
+    AccumulateAvx2(row, weight, size, scores);
+    return;
+  } else if (isa() == kSse4) {
+    AccumulateSse4(row, weight, size, scores);
+    return;
+  }
+#endif
+  AccumulateScalar(row, weight, size, scores);
+}
+
+void ScoreKernel::Accumulate(const int* row, const uint32_t weight,
+                             const int size, uint32_t* scores) {
+#ifdef BUSH_X86_KERNELS_
+  if (isa() == kAvx2) {
+    AccumulateAvx2(row, weight, size, scores);
+    return;
+  } else if (isa() == kSse4) {
+    AccumulateSse4(row, weight, size, scores);
+    return;
+  }
+#endif
+  AccumulateScalar(row, weight, size, scores);
+}
+
+void ScoreKernel::Accumulate(const int* row, const uint16_t weight,
+                             const int size, uint16_t* scores) {
+  AccumulateScalar(row, weight, size, scores);
+}
+
+}  // namespace bush
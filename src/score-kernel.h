@@ -0,0 +1,51 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_SCORE_KERNEL_H_
+#define SRC_SCORE_KERNEL_H_
+
+#include <cstdint>
+
+namespace bush {
+
+// Accumulation of weighted rating rows into structure-of-arrays score
+// vectors, the inner loop of the positional tallies. The rows are added using
+// AVX2 or SSE4.1 instructions if supported by the CPU, detected once at
+// runtime, and scalar code otherwise. Scores are unsigned and wrap around on
+// overflow, the caller chooses an accumulator type wide enough for the
+// highest possible score.
+class ScoreKernel {
+ public:
+  enum Isa {
+    kScalar,
+    kSse4,
+    kAvx2
+  };
+
+  // Returns the instruction set used by the kernels.
+  static Isa isa();
+
+  // Restricts the kernels to the given instruction set, which has to be
+  // supported by the CPU. Used to compare the code paths.
+  static void set_isa(const Isa isa);
+
+  // Returns the best instruction set supported by the CPU.
+  static Isa DetectIsa();
+
+  // Returns the name of the instruction set.
+  static const char* IsaName(const Isa isa);
+
+  // Adds weight * row[c] to scores[c] for all c in [0, size).
+  static void Accumulate(const uint16_t* row, const uint16_t weight,
+                         const int size, uint16_t* scores);
+  static void Accumulate(const uint16_t* row, const uint32_t weight,
+                         const int size, uint32_t* scores);
+  static void Accumulate(const int* row, const uint32_t weight,
+                         const int size, uint32_t* scores);
+  // Int rows only occur for more than CompactVote::MaxCandidates() = 256
+  // candidates. 16-bit scores need V * (C - 1) <= 65535, which leaves at most
+  // 255 voters for C >= 257, so this variant is scalar only.
+  static void Accumulate(const int* row, const uint16_t weight,
+                         const int size, uint16_t* scores);
+};
+
+}  // namespace bush
+#endif  // SRC_SCORE_KERNEL_H_
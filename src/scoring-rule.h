@@ -0,0 +1,59 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_SCORING_RULE_H_
+#define SRC_SCORING_RULE_H_
+
+#include <string>
+
+namespace bush {
+
+// Positional scoring rules for ScoringSystem. A rule gives the points a
+// candidate receives for each position of a ballot, non-increasing from the
+// top position 0 to the bottom position num_candidates - 1. The score vector
+// is known at compile time up to the number of candidates, so the tally and
+// search loops are specialised for each rule. The rule's name selects it on
+// the command line.
+
+// One point for the top choice.
+struct PluralityRule {
+  static std::string Name() { return "plurality"; }
+  static const bool kRatingScores = false;
+
+  static constexpr int Score(const int position, const int) {
+    return position == 0;
+  }
+};
+
+// num_candidates - 1 - position points, the scores are the ratings.
+struct BordaRule {
+  static std::string Name() { return "borda"; }
+  // The scores equal the ratings, the tally accumulates the rating rows.
+  static const bool kRatingScores = true;
+
+  static constexpr int Score(const int position, const int num_candidates) {
+    return num_candidates - 1 - position;
+  }
+};
+
+// One point for every candidate but the last choice.
+struct VetoRule {
+  static std::string Name() { return "veto"; }
+  static const bool kRatingScores = false;
+
+  static constexpr int Score(const int position, const int num_candidates) {
+    return position < num_candidates - 1;
+  }
+};
+
+// One point for each of the top K choices.
+template<int K>
+struct ApprovalRule {
+  static std::string Name() { return std::to_string(K) + "-approval"; }
+  static const bool kRatingScores = false;
+
+  static constexpr int Score(const int position, const int) {
+    return position < K;
+  }
+};
+
+}  // namespace bush
+#endif  // SRC_SCORING_RULE_H_
@@ -0,0 +1,433 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include "./scoring-system.h"
+#include <cassert>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "./vote.h"
+#include "./sampler.h"
+#include "./score-kernel.h"
+#include "./stats.h"
+#include "./thread-pool.h"
+#include "./trace.h"
+
+using std::string;
+using std::vector;
+using std::pair;
+using std::make_pair;
+using std::sort;
+using std::max;
+using std::max_element;
+using std::numeric_limits;
+using base::Deadline;
+using base::Stats;
+using base::ThreadPool;
+using base::Trace;
+
+namespace bush {
+
+struct Compare {
+  bool operator()(const pair<int, int>& lhs, const pair<int, int>& rhs) const {
+    // Prefer greater rating but lower id (reversed!).
+    return lhs.first < rhs.first ||
+           (lhs.first == rhs.first && lhs.second > rhs.second);
+  }
+};
+
+// Returns the points of the rule for each position.
+template<class Rule>
+static vector<int> PositionScores(const int num_candidates) {
+  vector<int> scores(num_candidates);
+  for (int p = 0; p < num_candidates; ++p) {
+    scores[p] = Rule::Score(p, num_candidates);
+  }
+  return scores;
+}
+
+// Returns the points the voter of the ratings gives the candidate.
+template<class Rule, class RatingRow>
+static inline int VoterScore(const RatingRow& ratings, const int candidate,
+                             const int num_candidates) {
+  return Rule::Score(num_candidates - 1 - ratings[candidate], num_candidates);
+}
+
+// Returns the tally of the vote accumulated in Score, which has to hold the
+// highest possible rating.
+template<typename Score, class VoteType>
+static vector<int> AccumulateTally(const VoteType& vote) {
+  const int num_ballots = vote.num_ballots();
+  const int num_candidates = vote.num_candidates();
+  vector<Score> scores(num_candidates, 0);
+  for (int b = 0; b < num_ballots; ++b) {
+    const int weight = vote.count(b);
+    if (weight) {
+      ScoreKernel::Accumulate(vote.ballot_ratings(b).data(),
+                              static_cast<Score>(weight), num_candidates,
+                              scores.data());
+    }
+  }
+  return vector<int>(scores.begin(), scores.end());
+}
+
+// Returns the tally of the rule, which gives the score common to most
+// positions to all candidates at once and adds only the deviations of the
+// other positions per ballot.
+template<class Rule, class VoteType>
+static vector<int> DeviationTally(const VoteType& vote) {
+  const int num_ballots = vote.num_ballots();
+  const int num_candidates = vote.num_candidates();
+  vector<int> tally(num_candidates, 0);
+  if (!num_candidates) {
+    return tally;
+  }
+  const vector<int> scores = PositionScores<Rule>(num_candidates);
+  // The common score is the one of the top or the bottom position, whichever
+  // leaves fewer deviating positions.
+  int top_deviations = 0;
+  int bottom_deviations = 0;
+  for (int p = 0; p < num_candidates; ++p) {
+    top_deviations += scores[p] != scores[0];
+    bottom_deviations += scores[p] != scores[num_candidates - 1];
+  }
+  const int common = top_deviations < bottom_deviations ?
+                     scores[0] : scores[num_candidates - 1];
+  vector<int> positions;
+  vector<int> deviations;
+  for (int p = 0; p < num_candidates; ++p) {
+    if (scores[p] != common) {
+      positions.push_back(p);
+      deviations.push_back(scores[p] - common);
+    }
+  }
+  const int num_positions = positions.size();
+  int total_weight = 0;
+  for (int b = 0; b < num_ballots; ++b) {
+    const int weight = vote.count(b);
+    if (!weight) {
+      continue;
+    }
+    total_weight += weight;
+    const typename VoteType::Row ballot = vote.ballot(b);
+    for (int i = 0; i < num_positions; ++i) {
+      tally[ballot[positions[i]]] += weight * deviations[i];
+    }
+  }
+  if (common) {
+    for (int c = 0; c < num_candidates; ++c) {
+      tally[c] += common * total_weight;
+    }
+  }
+  return tally;
+}
+
+template<class Rule, class VoteType>
+ScoringSystem<Rule, VoteType>::ScoringSystem(
+    const VoteType& vote, const VotingSystem::Strategy strategy,
+    const VotingSystem::Options& options)
+    : vote_(vote),
+      strategy_(strategy),
+      options_(options),
+      base_ratings_(Tally(vote)),
+      strategic_vote_(0, 0) {
+  Preprocess();
+}
+
+template<class Rule, class VoteType>
+ScoringSystem<Rule, VoteType>::ScoringSystem(
+    const VoteType& vote, const int selected_voter_id,
+    const VotingSystem::Strategy strategy,
+    const VotingSystem::Options& options)
+    : vote_(vote),
+      strategy_(strategy),
+      options_(options),
+      base_ratings_(Tally(vote)),
+      strategic_vote_(0, 0) {
+  Preprocess();
+  strategic_preference_ = StrategicPreference(selected_voter_id);
+}
+
+template<class Rule, class VoteType>
+void ScoringSystem<Rule, VoteType>::Preprocess() {
+  if (strategy_ != VotingSystem::kComplete) {
+    return;
+  }
+  Stats::PhaseTimer timer(Stats::kPreprocess);
+  Trace::Span span("scoring.preprocess");
+  const int num_voters = vote_.num_voters();
+  const int num_ballots = vote_.num_ballots();
+  // Voters sharing a ballot share their strategic preference, it is computed
+  // once per ballot for a representative voter.
+  vector<int> ballot_voters(num_ballots);
+  for (int v = num_voters - 1; v >= 0; --v) {
+    ballot_voters[vote_.voter_ballot(v)] = v;
+  }
+  vector<vector<int> > ballot_prefs(num_ballots);
+  ThreadPool pool(options_.num_threads);
+  pool.ParallelFor(0, num_ballots, [&](const int b) {
+    Trace::Span span("scoring.voter_search", ballot_voters[b]);
+    ballot_prefs[b] = FindStrategicPreference(vote_, base_ratings_,
+                                              ballot_voters[b]);
+  });
+  strategic_vote_ = VoteType(vote_.num_candidates(), num_voters);
+  vector<int> strategic_ballots(num_ballots);
+  for (int b = 0; b < num_ballots; ++b) {
+    strategic_ballots[b] = strategic_vote_.AddBallot(ballot_prefs[b]);
+  }
+  for (int v = 0; v < num_voters; ++v) {
+    strategic_vote_.AssignBallot(v, strategic_ballots[vote_.voter_ballot(v)]);
+  }
+  strategic_ratings_ = Tally(strategic_vote_);
+}
+
+template<class Rule, class VoteType>
+vector<int> ScoringSystem<Rule, VoteType>::StrategicPreference(
+    const int selected_voter) const {
+  Stats::PhaseTimer timer(Stats::kSearch);
+  Trace::Span span("scoring.search", selected_voter);
+  if (strategy_ == VotingSystem::kSimple) {
+    return FindStrategicPreference(vote_, base_ratings_, selected_voter);
+  } else if (strategy_ == VotingSystem::kComplete) {
+    // The selected voter keeps its sincere preference.
+    const int num_candidates = vote_.num_candidates();
+    const typename VoteType::RatingRow strategic_ratings =
+        strategic_vote_.ratings(selected_voter);
+    const typename VoteType::RatingRow sincere_ratings =
+        vote_.ratings(selected_voter);
+    vector<int> tally = strategic_ratings_;
+    for (int c = 0; c < num_candidates; ++c) {
+      tally[c] += VoterScore<Rule>(sincere_ratings, c, num_candidates) -
+                  VoterScore<Rule>(strategic_ratings, c, num_candidates);
+    }
+    return FindStrategicPreference(vote_, tally, selected_voter);
+  } else if (strategy_ == VotingSystem::kIndependent) {
+    // The utility is measured on the sincere vote.
+    const int utility = Utility(vote_, base_ratings_, selected_voter);
+    Sampler<VoteType> sampler(vote_, selected_voter, options_.num_threads,
+                              options_.clock_type, options_.time_limit);
+    return sampler.Run([selected_voter, utility](const VoteType& sample,
+                                                 const int,
+                                                 int* sample_utility) {
+      *sample_utility = utility;
+      return FindStrategicPreference(sample, Tally(sample), selected_voter);
+    });
+  }
+  const typename VoteType::Row pref = vote_.preference(selected_voter);
+  return vector<int>(pref.begin(), pref.end());
+}
+
+template<class Rule, class VoteType>
+vector<int> ScoringSystem<Rule, VoteType>::FindStrategicPreference(
+    const VoteType& vote, const vector<int>& tally, const int selected_voter) {
+  const int num_candidates = vote.num_candidates();
+  const typename VoteType::RatingRow selected_ratings =
+      vote.ratings(selected_voter);
+  // Vector of (rating, candidate id) pairs, ignoring the selected voter.
+  vector<pair<int, int> > ratings;
+  ratings.reserve(num_candidates);
+  for (int c = 0; c < num_candidates; ++c) {
+    ratings.push_back(make_pair(
+        tally[c] - VoterScore<Rule>(selected_ratings, c, num_candidates), c));
+  }
+  sort(ratings.begin(), ratings.end(), Compare());
+  const int max_rating = ratings.back().first;
+  // The selected voter can lift a candidate by at most the difference of the
+  // top and the bottom score.
+  const int max_lift = Rule::Score(0, num_candidates) -
+                       Rule::Score(num_candidates - 1, num_candidates);
+  // Find the best winner candidate.
+  int best_candidate = 0;
+  int best_rating = 0;
+  vector<int> hopes(num_candidates);
+  for (int i = 0; i < num_candidates; ++i) {
+    const int rating = ratings[i].first;
+    const int candidate = ratings[i].second;
+    // Discretise rating: 1 for a winner candidate and 0 for a loser.
+    const int discrete_rating = max_rating - rating <= max_lift;
+    hopes[candidate] = discrete_rating * selected_ratings[candidate];
+    if (hopes[candidate] > best_rating) {
+      best_rating = hopes[candidate];
+      best_candidate = candidate;
+    }
+  }
+  vector<int> strategic_preference;
+  strategic_preference.reserve(num_candidates);
+  // Only boost the top candidate to reduce the chance of second-choice winners.
+  strategic_preference.push_back(best_candidate);
+  // Reduce the chance of other candidates winning by prefering harmless ones
+  // on the positions scoring more than the last one.
+  int num_scoring = 0;
+  for (int p = 1; p < num_candidates; ++p) {
+    num_scoring += Rule::Score(p, num_candidates) >
+                   Rule::Score(num_candidates - 1, num_candidates);
+  }
+  vector<pair<int, int> > harmless;
+  harmless.reserve(num_candidates);
+  for (int i = 0; i < num_candidates; ++i) {
+    if (ratings[i].second != best_candidate) {
+      // Harmlessness rating is the inverted chance for this candidate to win.
+      harmless.push_back(make_pair(max_rating - ratings[i].first,
+                                   ratings[i].second));
+    }
+  }
+  sort(harmless.begin(), harmless.end(), Compare());
+  while (num_scoring--) {
+    strategic_preference.push_back(harmless.back().second);
+    harmless.pop_back();
+  }
+  // The order of the other positions does not matter, they keep the hopeful
+  // candidates first.
+  for (auto it = harmless.begin(), end = harmless.end(); it != end; ++it) {
+    it->first = hopes[it->second];
+  }
+  sort(harmless.begin(), harmless.end(), Compare());
+  for (auto it = harmless.crbegin(), end = harmless.crend(); it != end; ++it) {
+    strategic_preference.push_back(it->second);
+  }
+  return strategic_preference;
+}
+
+template<class Rule, class VoteType>
+vector<int> ScoringSystem<Rule, VoteType>::CoalitionPreference(
+    const Coalition<VoteType>& coalition, Deadline* deadline,
+    int* sincere_winner, int* winner) {
+  Trace::Span span("scoring.coalition_search", coalition.size());
+  const VoteType& vote = coalition.vote();
+  const int num_candidates = vote.num_candidates();
+  vector<int> tally = Tally(vote);
+  *sincere_winner = max_element(tally.begin(), tally.end()) - tally.begin();
+  *winner = *sincere_winner;
+  // Remove the coalition from the tally, once per ballot.
+  const vector<int>& ballots = coalition.ballots();
+  const vector<int>& weights = coalition.weights();
+  const int num_ballots = ballots.size();
+  for (int i = 0; i < num_ballots; ++i) {
+    const typename VoteType::RatingRow ratings =
+        vote.ballot_ratings(ballots[i]);
+    for (int c = 0; c < num_candidates; ++c) {
+      tally[c] -= weights[i] * VoterScore<Rule>(ratings, c, num_candidates);
+    }
+  }
+  // The most harmless candidates get the highest scores after the target,
+  // the lower id is more harmful on ties.
+  vector<pair<int, int> > harmless;
+  harmless.reserve(num_candidates);
+  for (int c = 0; c < num_candidates; ++c) {
+    harmless.push_back(make_pair(tally[c], c));
+  }
+  sort(harmless.begin(), harmless.end(), Compare());
+  const vector<int> scores = PositionScores<Rule>(num_candidates);
+  const int weight = coalition.size();
+  const vector<int> targets = coalition.Targets(*sincere_winner);
+  vector<int> pref;
+  pref.reserve(num_candidates);
+  // The best target is tried even if the deadline has already expired.
+  for (auto it = targets.cbegin(), end = targets.cend();
+       it != end && (it == targets.cbegin() || !deadline->Expired()); ++it) {
+    const int target = *it;
+    pref.assign(1, target);
+    for (auto h = harmless.cbegin(), h_end = harmless.cend(); h != h_end;
+         ++h) {
+      if (h->second != target) {
+        pref.push_back(h->second);
+      }
+    }
+    // The joint preference adds the scores of its positions, weighted by the
+    // coalition size.
+    Stats::Count(Stats::kFindWinnerCalls);
+    int pref_winner = target;
+    int winner_rating = tally[target] + weight * scores[0];
+    for (int p = 1; p < num_candidates; ++p) {
+      const int candidate = pref[p];
+      const int rating = tally[candidate] + weight * scores[p];
+      if (rating > winner_rating ||
+          (rating == winner_rating && candidate < pref_winner)) {
+        winner_rating = rating;
+        pref_winner = candidate;
+      }
+    }
+    if (pref_winner == target) {
+      *winner = target;
+      return pref;
+    }
+  }
+  // No joint ballot is reported, the voters keep their sincere ballots.
+  return vector<int>();
+}
+
+template<class Rule, class VoteType>
+int ScoringSystem<Rule, VoteType>::Utility(const VoteType& vote,
+                                           const int selected_voter) {
+  return Utility(vote, Tally(vote), selected_voter);
+}
+
+template<class Rule, class VoteType>
+int ScoringSystem<Rule, VoteType>::Utility(const VoteType& vote,
+                                           const vector<int>& tally,
+                                           const int selected_voter) {
+  Stats::Count(Stats::kUtilityCalls);
+  Stats::Count(Stats::kFindWinnerCalls);
+  const int num_candidates = vote.num_candidates();
+  // Ignore the selected voter.
+  const typename VoteType::RatingRow selected_ratings =
+      vote.ratings(selected_voter);
+  // The winner has the greatest rating, the lowest id on ties.
+  int winner = 0;
+  int winner_rating = tally[0] -
+                      VoterScore<Rule>(selected_ratings, 0, num_candidates);
+  for (int c = 1; c < num_candidates; ++c) {
+    const int rating = tally[c] -
+                       VoterScore<Rule>(selected_ratings, c, num_candidates);
+    if (rating > winner_rating) {
+      winner_rating = rating;
+      winner = c;
+    }
+  }
+  return selected_ratings[winner];
+}
+
+template<class Rule, class VoteType>
+vector<int> ScoringSystem<Rule, VoteType>::Tally(const VoteType& vote) {
+  if (!Rule::kRatingScores) {
+    return DeviationTally<Rule>(vote);
+  }
+  // The narrowest score type holding the highest possible rating packs the
+  // most candidates into each vector instruction.
+  const int64_t max_rating = static_cast<int64_t>(vote.num_voters()) *
+                             max(0, vote.num_candidates() - 1);
+  if (max_rating <= numeric_limits<uint16_t>::max()) {
+    return AccumulateTally<uint16_t>(vote);
+  }
+  // The parsers reject more than MaxVoters() voters.
+  assert(max_rating <= numeric_limits<int>::max());
+  return AccumulateTally<uint32_t>(vote);
+}
+
+template<class Rule, class VoteType>
+string ScoringSystem<Rule, VoteType>::Name() {
+  return Rule::Name();
+}
+
+template<class Rule, class VoteType>
+const vector<int>& ScoringSystem<Rule, VoteType>::base_ratings() const {
+  return base_ratings_;
+}
+
+template<class Rule, class VoteType>
+const vector<int>& ScoringSystem<Rule, VoteType>::strategic_preference()
+    const {
+  return strategic_preference_;
+}
+
+template class ScoringSystem<PluralityRule, Vote>;
+template class ScoringSystem<PluralityRule, CompactVote>;
+template class ScoringSystem<BordaRule, Vote>;
+template class ScoringSystem<BordaRule, CompactVote>;
+template class ScoringSystem<VetoRule, Vote>;
+template class ScoringSystem<VetoRule, CompactVote>;
+template class ScoringSystem<ApprovalRule<2>, Vote>;
+template class ScoringSystem<ApprovalRule<2>, CompactVote>;
+template class ScoringSystem<ApprovalRule<3>, Vote>;
+template class ScoringSystem<ApprovalRule<3>, CompactVote>;
+
+}  // namespace bush
@@ -0,0 +1,84 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_SCORING_SYSTEM_H_
+#define SRC_SCORING_SYSTEM_H_
+
+#include <string>
+#include <vector>
+#include "./coalition.h"
+#include "./scoring-rule.h"
+#include "./voting-system.h"
+#include "./clock.h"
+#include "./deadline.h"
+
+namespace bush {
+
+// Positional scoring voting system of the Rule, the candidate with the most
+// points wins, the lowest id on ties. The strategic preference puts the most
+// preferred candidate that can still win first, the most harmless
+// competitors on the remaining scoring positions and the other candidates by
+// decreasing hope on the positions scoring the same as the last one.
+template<class Rule, class VoteType>
+class ScoringSystem : public VotingSystem {
+ public:
+  // Returns the name of the voting system.
+  static std::string Name();
+  // Returns the ratings of all candidates accumulated over all voters.
+  static std::vector<int> Tally(const VoteType& vote);
+  static int Utility(const VoteType& vote, const int selected_voter);
+  // Returns the utility for the selected voter given the precomputed tally of
+  // all voters, the selected voter's contribution is subtracted in O(C).
+  static int Utility(const VoteType& vote, const std::vector<int>& tally,
+                     const int selected_voter);
+  // Returns the joint preference of the coalition against the sincere other
+  // voters, which puts the best shared target that can win first and the
+  // other candidates by increasing tally of the others. Returns an empty
+  // preference if no target can win, the coalition's voters then keep their
+  // sincere ballots. Sets the sincere winner and the winner, which is the
+  // sincere winner if the preference is empty.
+  static std::vector<int> CoalitionPreference(
+      const Coalition<VoteType>& coalition, base::Deadline* deadline,
+      int* sincere_winner, int* winner);
+
+  // Precomputes the strategy for queries of any selected voter.
+  ScoringSystem(const VoteType& vote, const VotingSystem::Strategy strategy,
+                const VotingSystem::Options& options);
+  // Precomputes the strategy and computes the strategic preference of the
+  // selected voter.
+  ScoringSystem(const VoteType& vote, const int selected_voter_id,
+                const VotingSystem::Strategy strategy,
+                const VotingSystem::Options& options);
+  // Returns the strategic preference of the selected voter.
+  std::vector<int> StrategicPreference(const int selected_voter) const;
+  const std::vector<int>& base_ratings() const;
+  const std::vector<int>& strategic_preference() const;
+
+ private:
+  void Preprocess();
+  static std::vector<int> FindStrategicPreference(
+      const VoteType& vote, const std::vector<int>& tally,
+      const int selected_voter);
+
+  const VoteType& vote_;
+  VotingSystem::Strategy strategy_;
+  VotingSystem::Options options_;
+  std::vector<int> base_ratings_;
+  // Vote of all voters' nixon strategic preferences and its tally.
+  VoteType strategic_vote_;
+  std::vector<int> strategic_ratings_;
+  std::vector<int> strategic_preference_;
+};
+
+template<class VoteType>
+using Plurality = ScoringSystem<PluralityRule, VoteType>;
+
+template<class VoteType>
+using Borda = ScoringSystem<BordaRule, VoteType>;
+
+template<class VoteType>
+using Veto = ScoringSystem<VetoRule, VoteType>;
+
+template<int K, class VoteType>
+using Approval = ScoringSystem<ApprovalRule<K>, VoteType>;
+
+}  // namespace bush
+#endif  // SRC_SCORING_SYSTEM_H_
@@ -0,0 +1,58 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_SPAN_H_
+#define SRC_SPAN_H_
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace base {
+
+// Lightweight non-owning view of a contiguous sequence of elements.
+template<typename T>
+class Span {
+ public:
+  typedef typename std::remove_const<T>::type ValueType;
+
+  Span() : data_(nullptr), size_(0) {}
+
+  Span(T* data, const size_t size) : data_(data), size_(size) {}
+
+  // Views the given vector, which has to outlive the span.
+  Span(const std::vector<ValueType>& vec)  // NOLINT
+      : data_(vec.data()), size_(vec.size()) {}
+
+  T& operator[](const size_t i) const {
+    assert(i < size_);
+    return data_[i];
+  }
+
+  T* begin() const {
+    return data_;
+  }
+
+  T* end() const {
+    return data_ + size_;
+  }
+
+  T* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Returns a copy of the viewed elements.
+  std::vector<ValueType> vec() const {
+    return std::vector<ValueType>(data_, data_ + size_);
+  }
+
+ private:
+  T* data_;
+  size_t size_;
+};
+
+}  // namespace base
+#endif  // SRC_SPAN_H_
@@ -0,0 +1,171 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_STATS_H_
+#define SRC_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include "./clock.h"
+
+namespace base {
+
+// Process-wide instrumentation of the hot paths. Counters are incremented on
+// thread-local copies, which are summed on report and folded into the totals
+// when their thread exits. They are only compiled in with BUSH_STATS_
+// defined, otherwise Count is empty and the calls vanish. Phase times are
+// always measured, they are taken once per phase on the wall clock.
+class Stats {
+ public:
+#ifdef BUSH_STATS_
+  static const bool kEnabled = true;
+#else
+  static const bool kEnabled = false;
+#endif
+
+  enum Counter {
+    kUtilityCalls,
+    // Winner determinations of all voting systems, the unit of search work.
+    kFindWinnerCalls,
+    kIrvRounds,
+    kVisitedHits,
+    kVisitedMisses,
+    kSamples,
+    kDistinctSamples,
+    kNumCounters
+  };
+
+  enum Phase { kParse, kPreprocess, kSearch, kNumPhases };
+
+  // Measures the wall-clock time from construction to destruction for the
+  // phase.
+  class PhaseTimer {
+   public:
+    explicit PhaseTimer(const Phase phase)
+        : phase_(phase),
+          beg_(Clock::kRealMonotonic) {}
+
+    ~PhaseTimer() {
+      AddTime(phase_, Clock(Clock::kRealMonotonic) - beg_);
+    }
+
+   private:
+    Phase phase_;
+    Clock beg_;
+  };
+
+  // Adds n to the counter of the calling thread.
+  static void Count(const Counter counter, const uint64_t n = 1) {
+    if (kEnabled) {
+      LocalCounts().counts[counter] += n;
+    }
+  }
+
+  // Adds the time in microseconds to the phase.
+  static void AddTime(const Phase phase, const Clock::Diff time) {
+    Totals().phase_times[phase] += time;
+  }
+
+  // Returns the counter summed over all threads.
+  static uint64_t count(const Counter counter) {
+    Registry& totals = Totals();
+    std::lock_guard<std::mutex> lock(totals.mutex);
+    uint64_t sum = totals.counts[counter];
+    for (auto it = totals.locals.cbegin(), end = totals.locals.cend();
+         it != end; ++it) {
+      sum += (*it)->counts[counter];
+    }
+    return sum;
+  }
+
+  // Returns the time in microseconds spent in the phase, summed over all
+  // threads.
+  static Clock::Diff time(const Phase phase) {
+    return Totals().phase_times[phase];
+  }
+
+  // Returns the counters and phase times as JSON object.
+  static std::string Json() {
+    static const char* kCounterNames[kNumCounters] = {
+      "utility_calls", "find_winner_calls", "irv_rounds", "visited_hits",
+      "visited_misses", "samples", "distinct_samples"
+    };
+    static const char* kPhaseNames[kNumPhases] = {
+      "parse", "preprocess", "search"
+    };
+    std::stringstream ss;
+    ss << "{\"counters_enabled\": " << (kEnabled ? "true" : "false")
+       << ", \"counters\": {";
+    if (kEnabled) {
+      for (int c = 0; c < kNumCounters; ++c) {
+        ss << (c ? ", " : "") << "\"" << kCounterNames[c] << "\": "
+           << count(static_cast<Counter>(c));
+      }
+    }
+    ss << "}, \"phase_time_us\": {";
+    for (int p = 0; p < kNumPhases; ++p) {
+      ss << (p ? ", " : "") << "\"" << kPhaseNames[p] << "\": "
+         << time(static_cast<Phase>(p));
+    }
+    ss << "}}";
+    return ss.str();
+  }
+
+ private:
+  struct Local;
+
+  // Totals of the exited threads and the live thread-local counters.
+  struct Registry {
+    Registry() {
+      for (int c = 0; c < kNumCounters; ++c) {
+        counts[c] = 0;
+      }
+      for (int p = 0; p < kNumPhases; ++p) {
+        phase_times[p] = 0;
+      }
+    }
+
+    std::mutex mutex;
+    uint64_t counts[kNumCounters];
+    std::set<const Local*> locals;
+    std::atomic<Clock::Diff> phase_times[kNumPhases];
+  };
+
+  // Counters of a thread, registered for its lifetime.
+  struct Local {
+    Local() {
+      for (int c = 0; c < kNumCounters; ++c) {
+        counts[c] = 0;
+      }
+      Registry& totals = Totals();
+      std::lock_guard<std::mutex> lock(totals.mutex);
+      totals.locals.insert(this);
+    }
+
+    ~Local() {
+      Registry& totals = Totals();
+      std::lock_guard<std::mutex> lock(totals.mutex);
+      for (int c = 0; c < kNumCounters; ++c) {
+        totals.counts[c] += counts[c];
+      }
+      totals.locals.erase(this);
+    }
+
+    uint64_t counts[kNumCounters];
+  };
+
+  static Registry& Totals() {
+    static Registry totals;
+    return totals;
+  }
+
+  static Local& LocalCounts() {
+    static thread_local Local local;
+    return local;
+  }
+};
+
+}  // namespace base
+#endif  // SRC_STATS_H_
@@ -0,0 +1,65 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_SYSTEM_REGISTRY_H_
+#define SRC_SYSTEM_REGISTRY_H_
+
+#include <string>
+#include <vector>
+#include "./vote.h"
+#include "./scoring-system.h"
+#include "./pairwise-system.h"
+#include "./irv-system.h"
+
+namespace bush {
+
+// List of voting system types, which dispatches a voting system name to a
+// visitor's template Visit<System>() call for the system of that name.
+template<class... Systems>
+struct SystemList;
+
+template<>
+struct SystemList<> {
+  template<class Visitor>
+  static bool Visit(const std::string&, Visitor*) {
+    return false;
+  }
+
+  static void AppendNames(std::vector<std::string>*) {}
+};
+
+template<class System, class... Rest>
+struct SystemList<System, Rest...> {
+  // Calls the visitor for the system of given name, returns false if there is
+  // no system of that name.
+  template<class Visitor>
+  static bool Visit(const std::string& name, Visitor* visitor) {
+    if (name == System::Name()) {
+      visitor->template Visit<System>();
+      return true;
+    }
+    return SystemList<Rest...>::Visit(name, visitor);
+  }
+
+  // Appends the system names in list order.
+  static void AppendNames(std::vector<std::string>* names) {
+    names->push_back(System::Name());
+    SystemList<Rest...>::AppendNames(names);
+  }
+};
+
+// The voting systems of the preferences of VoteType. A system added here is
+// available to all modes of bush and to bush-bench.
+template<class VoteType>
+using VotingSystems = SystemList<Plurality<VoteType>, Irv<VoteType>,
+                                 Borda<VoteType>, Veto<VoteType>,
+                                 Approval<2, VoteType>, Approval<3, VoteType>,
+                                 Copeland<VoteType>, Schulze<VoteType> >;
+
+// Returns the names of the voting systems.
+inline std::vector<std::string> VotingSystemNames() {
+  std::vector<std::string> names;
+  VotingSystems<Vote>::AppendNames(&names);
+  return names;
+}
+
+}  // namespace bush
+#endif  // SRC_SYSTEM_REGISTRY_H_
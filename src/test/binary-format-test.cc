@@ -0,0 +1,134 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../binary-format.h"
+#include "../parser.h"
+#include "../vote.h"
+#include "./reference.h"
+
+using std::fstream;
+using std::ofstream;
+using std::string;
+using std::vector;
+using std::mt19937;
+using bush::BinaryFormat;
+using bush::Parser;
+using bush::Vote;
+using bush::CompactVote;
+using bush::reference::Profile;
+
+namespace {
+
+// Writes the text to the file at given path.
+void WriteText(const string& path, const string& text) {
+  ofstream stream(path.c_str());
+  stream << text;
+}
+
+// Returns the vote parsed from the file at given path, expecting no error.
+template<class VoteType>
+VoteType ParseFile(const string& path) {
+  Parser parser(path, 1);
+  const VoteType vote = parser.ParseVote<VoteType>();
+  EXPECT_EQ("", parser.error()) << path;
+  return vote;
+}
+
+// Converts the text of random profiles to the binary format and back, as
+// bush-convert does, and checks that the text and the ballots are kept.
+void CheckRoundTrip(const bool weighted, const int max_candidates,
+                    const int seed) {
+  const string text_path = testing::TempDir() + "binary-format-test.vote";
+  const string binary_path = testing::TempDir() + "binary-format-test.bin";
+  mt19937 random(seed);
+  for (int trial = 0; trial < 50; ++trial) {
+    const int num_candidates = 1 + random() % max_candidates;
+    const int num_voters = 1 + random() % 40;
+    const Profile profile = bush::reference::RandomProfile(num_candidates,
+                                                           num_voters,
+                                                           &random);
+    const string text =
+        bush::reference::ToVote<Vote>(profile, num_candidates).str();
+    WriteText(text_path, text);
+    const Vote vote = ParseFile<Vote>(text_path);
+    ASSERT_TRUE(BinaryFormat::Write(vote, weighted, binary_path));
+    Vote binary_vote = ParseFile<Vote>(binary_path);
+    ASSERT_EQ(text, binary_vote.str()) << "trial " << trial;
+    ASSERT_EQ(vote.num_ballots(), binary_vote.num_ballots())
+        << "trial " << trial;
+    for (int b = 0; b < vote.num_ballots(); ++b) {
+      ASSERT_EQ(vote.count(b), binary_vote.count(b)) << "trial " << trial;
+      // Known ballots are found again after loading.
+      ASSERT_EQ(b, binary_vote.AddBallot(vote.ballot(b)))
+          << "trial " << trial;
+    }
+    if (num_candidates <= CompactVote::MaxCandidates()) {
+      ASSERT_EQ(text, ParseFile<CompactVote>(binary_path).str())
+          << "trial " << trial;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(BinaryFormatTest, WeightedRoundTrip) {
+  CheckRoundTrip(true, 10, 9);
+}
+
+TEST(BinaryFormatTest, UnweightedRoundTrip) {
+  CheckRoundTrip(false, 10, 90);
+}
+
+TEST(BinaryFormatTest, WideIdRoundTrip) {
+  CheckRoundTrip(true, 300, 900);
+}
+
+TEST(BinaryFormatTest, RejectsRepeatedCandidate) {
+  const string binary_path = testing::TempDir() + "binary-format-test.bin";
+  Vote vote(3, 2);
+  vote.AddPreference(0, vector<int>({0, 1, 2}));
+  vote.AddPreference(1, vector<int>({2, 1, 0}));
+  ASSERT_TRUE(BinaryFormat::Write(vote, true, binary_path));
+  {
+    // The second id of the first ballot repeats the first one.
+    fstream stream(binary_path.c_str(),
+                   std::ios::in | std::ios::out | std::ios::binary);
+    stream.seekp(sizeof(BinaryFormat::Header) + 1);
+    stream.put(0);
+  }
+  Parser parser(binary_path, 1);
+  parser.ParseVote<Vote>();
+  EXPECT_NE(string::npos, parser.error().find("not a permutation"))
+      << parser.error();
+}
+
+TEST(BinaryFormatTest, RejectsTooManyVoters) {
+  // 500 candidates and 5M voters overflow the int Borda tallies.
+  const string text_path = testing::TempDir() + "binary-format-test.vote";
+  WriteText(text_path, "500 5000000\n");
+  Parser text_parser(text_path, 1);
+  text_parser.ParseVote<Vote>();
+  EXPECT_NE(string::npos, text_parser.error().find("too many voters"))
+      << text_parser.error();
+
+  const string binary_path = testing::TempDir() + "binary-format-test.bin";
+  Vote vote(3, 1);
+  vote.AddPreference(0, vector<int>({0, 1, 2}));
+  ASSERT_TRUE(BinaryFormat::Write(vote, true, binary_path));
+  {
+    fstream stream(binary_path.c_str(),
+                   std::ios::in | std::ios::out | std::ios::binary);
+    BinaryFormat::Header header;
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    header.num_voters = Vote::MaxVoters(3) + 1u;
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  Parser binary_parser(binary_path, 1);
+  binary_parser.ParseVote<Vote>();
+  EXPECT_NE(string::npos, binary_parser.error().find("too many voters"))
+      << binary_parser.error();
+}
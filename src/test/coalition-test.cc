@@ -0,0 +1,113 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "../coalition.h"
+#include "../clock.h"
+#include "../deadline.h"
+#include "../irv-system.h"
+#include "../pairwise-system.h"
+#include "../scoring-system.h"
+#include "../vote.h"
+#include "./reference.h"
+
+using std::vector;
+using std::mt19937;
+using base::Clock;
+using base::Deadline;
+using bush::Coalition;
+using bush::CompactVote;
+using bush::Plurality;
+using bush::Borda;
+using bush::Veto;
+using bush::Copeland;
+using bush::Schulze;
+using bush::Irv;
+using bush::PluralityRule;
+using bush::BordaRule;
+using bush::VetoRule;
+using bush::reference::Profile;
+
+namespace {
+
+// Checks the winners reported for the joint preference of random coalitions,
+// mostly of voters with different ballots, against the reference winner of
+// the profile in which the coalition's voters cast the joint preference, or
+// keep their sincere ballots if there is none.
+template<class System>
+void CheckCoalitions(int (*reference_winner)(const Profile&, const int),
+                     const int seed) {
+  mt19937 random(seed);
+  int num_sincere = 0;
+  int num_joint = 0;
+  for (int trial = 0; trial < 300; ++trial) {
+    const int num_candidates = 2 + random() % 5;
+    const int num_voters = 2 + random() % 13;
+    Profile profile = bush::reference::RandomProfile(num_candidates,
+                                                     num_voters, &random);
+    const CompactVote vote =
+        bush::reference::ToVote<CompactVote>(profile, num_candidates);
+    vector<int> voters;
+    for (int v = 0; v < num_voters; ++v) {
+      if (random() % 2) {
+        voters.push_back(v);
+      }
+    }
+    if (voters.empty()) {
+      voters.push_back(random() % num_voters);
+    }
+    const Coalition<CompactVote> coalition(vote, voters);
+    Deadline deadline(Clock::kThreadCpuTime, 60 * Clock::kMicroInSec);
+    int sincere_winner = -1;
+    int winner = -1;
+    const vector<int> pref = System::CoalitionPreference(
+        coalition, &deadline, &sincere_winner, &winner);
+    ASSERT_EQ(reference_winner(profile, num_candidates), sincere_winner)
+        << "trial " << trial;
+    if (pref.empty()) {
+      EXPECT_EQ(sincere_winner, winner) << "trial " << trial;
+      ++num_sincere;
+      continue;
+    }
+    for (auto it = voters.cbegin(), end = voters.cend(); it != end; ++it) {
+      profile[*it] = pref;
+    }
+    EXPECT_EQ(reference_winner(profile, num_candidates), winner)
+        << "trial " << trial;
+    EXPECT_GT(coalition.utility(winner), coalition.utility(sincere_winner))
+        << "trial " << trial;
+    ++num_joint;
+  }
+  EXPECT_GT(num_sincere, 0);
+  EXPECT_GT(num_joint, 0);
+}
+
+}  // namespace
+
+TEST(CoalitionTest, PluralityWinnersMatchReference) {
+  CheckCoalitions<Plurality<CompactVote> >(
+      bush::reference::ScoringWinner<PluralityRule>, 25);
+}
+
+TEST(CoalitionTest, BordaWinnersMatchReference) {
+  CheckCoalitions<Borda<CompactVote> >(
+      bush::reference::ScoringWinner<BordaRule>, 250);
+}
+
+TEST(CoalitionTest, VetoWinnersMatchReference) {
+  CheckCoalitions<Veto<CompactVote> >(
+      bush::reference::ScoringWinner<VetoRule>, 251);
+}
+
+TEST(CoalitionTest, CopelandWinnersMatchReference) {
+  CheckCoalitions<Copeland<CompactVote> >(bush::reference::CopelandWinner,
+                                          252);
+}
+
+TEST(CoalitionTest, SchulzeWinnersMatchReference) {
+  CheckCoalitions<Schulze<CompactVote> >(bush::reference::SchulzeWinner, 253);
+}
+
+TEST(CoalitionTest, IrvWinnersMatchReference) {
+  CheckCoalitions<Irv<CompactVote> >(bush::reference::IrvWinner, 254);
+}
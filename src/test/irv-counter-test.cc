@@ -0,0 +1,83 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../irv-counter.h"
+#include "../vote.h"
+#include "./reference.h"
+
+using std::vector;
+using std::mt19937;
+using std::next_permutation;
+using bush::IrvCounter;
+using bush::Vote;
+using bush::CompactVote;
+using bush::reference::Profile;
+
+template<class VoteType>
+class IrvCounterTest : public testing::Test {};
+
+typedef testing::Types<Vote, CompactVote> VoteTypes;
+TYPED_TEST_SUITE(IrvCounterTest, VoteTypes);
+
+// Checks the trie count of random preferences of the selected voter against
+// the per-ballot recount, reusing one counter for all counts of a profile.
+TYPED_TEST(IrvCounterTest, MatchesRecount) {
+  mt19937 random(19);
+  for (int trial = 0; trial < 300; ++trial) {
+    const int num_candidates = 1 + random() % 10;
+    const int num_voters = 1 + random() % 20;
+    const Profile profile = bush::reference::RandomProfile(num_candidates,
+                                                           num_voters,
+                                                           &random);
+    const TypeParam vote =
+        bush::reference::ToVote<TypeParam>(profile, num_candidates);
+    IrvCounter<TypeParam> counter(vote);
+    for (int i = 0; i < 10; ++i) {
+      const int voter = random() % num_voters;
+      const vector<int> pref = i ?
+          bush::reference::RandomPreference(num_candidates, &random) :
+          profile[voter];
+      ASSERT_EQ(bush::reference::IrvWinner(profile, num_candidates, voter,
+                                           pref),
+                counter.FindWinner(voter, pref))
+          << "trial " << trial << ", count " << i;
+    }
+  }
+}
+
+// A margin above 1 guarantees that no single other voter can change the
+// winner with any ballot.
+TYPED_TEST(IrvCounterTest, MarginBoundsSingleVoterChanges) {
+  mt19937 random(119);
+  for (int trial = 0; trial < 200; ++trial) {
+    const int num_candidates = 2 + random() % 4;
+    const int num_voters = 2 + random() % 9;
+    const Profile profile = bush::reference::RandomProfile(num_candidates,
+                                                           num_voters,
+                                                           &random);
+    const TypeParam vote =
+        bush::reference::ToVote<TypeParam>(profile, num_candidates);
+    IrvCounter<TypeParam> counter(vote);
+    const int voter = random() % num_voters;
+    const int margin = counter.Margin(voter, profile[voter]);
+    ASSERT_GE(margin, 1);
+    if (margin == 1) {
+      continue;
+    }
+    const int winner = bush::reference::IrvWinner(profile, num_candidates);
+    for (int other = 0; other < num_voters; ++other) {
+      if (other == voter) {
+        continue;
+      }
+      vector<int> pref = profile[other];
+      std::sort(pref.begin(), pref.end());
+      do {
+        ASSERT_EQ(winner, bush::reference::IrvWinner(profile, num_candidates,
+                                                     other, pref))
+            << "trial " << trial << ", margin " << margin;
+      } while (next_permutation(pref.begin(), pref.end()));
+    }
+  }
+}
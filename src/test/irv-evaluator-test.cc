@@ -0,0 +1,62 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../irv-evaluator.h"
+#include "../vote.h"
+#include "./reference.h"
+
+using std::vector;
+using std::mt19937;
+using std::swap;
+using bush::IrvEvaluator;
+using bush::Vote;
+using bush::CompactVote;
+using bush::reference::Profile;
+
+template<class VoteType>
+class IrvEvaluatorTest : public testing::Test {};
+
+typedef testing::Types<Vote, CompactVote> VoteTypes;
+TYPED_TEST_SUITE(IrvEvaluatorTest, VoteTypes);
+
+// Evaluates a walk of preferences with the evaluator and checks each winner
+// against the full recount. The walk mixes swaps of neighbouring positions,
+// which keep most rounds, with swaps of the top position and fresh random
+// preferences, which undo early rounds, and steps back to earlier
+// preferences.
+TYPED_TEST(IrvEvaluatorTest, MatchesRecount) {
+  mt19937 random(18);
+  for (int trial = 0; trial < 200; ++trial) {
+    const int num_candidates = 2 + random() % 7;
+    const int num_voters = 1 + random() % 15;
+    const Profile profile = bush::reference::RandomProfile(num_candidates,
+                                                           num_voters,
+                                                           &random);
+    const int voter = random() % num_voters;
+    const TypeParam vote =
+        bush::reference::ToVote<TypeParam>(profile, num_candidates);
+    IrvEvaluator<TypeParam> evaluator(vote, voter);
+    vector<int> pref = profile[voter];
+    vector<vector<int> > history;
+    for (int step = 0; step < 100; ++step) {
+      const int move = random() % 4;
+      if (move == 0) {
+        const int i = random() % num_candidates;
+        swap(pref[i], pref[(i + 1) % num_candidates]);
+      } else if (move == 1) {
+        swap(pref[0], pref[random() % num_candidates]);
+      } else if (move == 2) {
+        pref = bush::reference::RandomPreference(num_candidates, &random);
+      } else if (!history.empty()) {
+        pref = history[random() % history.size()];
+      }
+      history.push_back(pref);
+      ASSERT_EQ(bush::reference::IrvWinner(profile, num_candidates, voter,
+                                           pref),
+                evaluator.FindWinner(pref))
+          << "trial " << trial << ", step " << step;
+    }
+  }
+}
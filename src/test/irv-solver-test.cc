@@ -0,0 +1,76 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../irv-solver.h"
+#include "../clock.h"
+#include "../deadline.h"
+#include "../vote.h"
+#include "./reference.h"
+
+using std::vector;
+using std::mt19937;
+using std::next_permutation;
+using base::Clock;
+using base::Deadline;
+using bush::IrvSolver;
+using bush::Vote;
+using bush::CompactVote;
+using bush::reference::Profile;
+
+namespace {
+
+// Returns the greatest utility the voter can reach with any preference,
+// trying all C! preferences.
+int BruteForceUtility(const Profile& profile, const int num_candidates,
+                      const int voter) {
+  vector<int> pref(num_candidates);
+  for (int c = 0; c < num_candidates; ++c) {
+    pref[c] = c;
+  }
+  int best_utility = 0;
+  do {
+    const int winner = bush::reference::IrvWinner(profile, num_candidates,
+                                                  voter, pref);
+    best_utility = std::max(best_utility,
+                            bush::reference::Rating(profile[voter], winner));
+  } while (next_permutation(pref.begin(), pref.end()));
+  return best_utility;
+}
+
+}  // namespace
+
+template<class VoteType>
+class IrvSolverTest : public testing::Test {};
+
+typedef testing::Types<Vote, CompactVote> VoteTypes;
+TYPED_TEST_SUITE(IrvSolverTest, VoteTypes);
+
+TYPED_TEST(IrvSolverTest, MatchesBruteForce) {
+  mt19937 random(14);
+  for (int trial = 0; trial < 300; ++trial) {
+    const int num_candidates = 2 + random() % 5;
+    const int num_voters = 1 + random() % 9;
+    const Profile profile = bush::reference::RandomProfile(num_candidates,
+                                                           num_voters,
+                                                           &random);
+    const int voter = random() % num_voters;
+    const TypeParam vote =
+        bush::reference::ToVote<TypeParam>(profile, num_candidates);
+    vector<int> ratings(num_candidates);
+    for (int c = 0; c < num_candidates; ++c) {
+      ratings[c] = bush::reference::Rating(profile[voter], c);
+    }
+    IrvSolver<TypeParam> solver(vote, voter);
+    Deadline deadline(Clock::kThreadCpuTime, 60 * Clock::kMicroInSec);
+    bool optimal = false;
+    const vector<int> pref = solver.Solve(profile[voter], ratings, &deadline,
+                                          &optimal);
+    EXPECT_TRUE(optimal);
+    const int winner = bush::reference::IrvWinner(profile, num_candidates,
+                                                  voter, pref);
+    EXPECT_EQ(BruteForceUtility(profile, num_candidates, voter),
+              ratings[winner]) << "trial " << trial;
+  }
+}
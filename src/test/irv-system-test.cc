@@ -0,0 +1,30 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include "../irv-system.h"
+#include "../clock.h"
+#include "../vote.h"
+#include "../voting-system.h"
+
+using base::Clock;
+using bush::Irv;
+using bush::Vote;
+using bush::CompactVote;
+using bush::VotingSystem;
+
+template<class VoteType>
+class IrvSystemTest : public testing::Test {};
+
+typedef testing::Types<Vote, CompactVote> VoteTypes;
+TYPED_TEST_SUITE(IrvSystemTest, VoteTypes);
+
+// The nixon precomputation of a vote without voters has nothing to triage.
+TYPED_TEST(IrvSystemTest, PreprocessesEmptyVote) {
+  const TypeParam vote(3, 0);
+  VotingSystem::Options options;
+  options.time_limit = Clock::kMicroInSec / 10;
+  for (int exact = 0; exact < 2; ++exact) {
+    options.exact = exact;
+    const Irv<TypeParam> irv(vote, VotingSystem::kComplete, options);
+    EXPECT_EQ(0, irv.search_report().num_items) << "exact " << exact;
+  }
+}
@@ -0,0 +1,68 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../pairwise-matrix.h"
+#include "../pairwise-rule.h"
+#include "../vote.h"
+#include "./reference.h"
+
+using std::vector;
+using std::mt19937;
+using bush::PairwiseMatrix;
+using bush::CopelandRule;
+using bush::SchulzeRule;
+using bush::CompactVote;
+using bush::reference::Profile;
+
+namespace {
+
+// Checks the winner of the rule's scores against the reference winner and
+// the rule's Wins against the winner of its scores for all candidates, on the
+// matrix of random profiles and after changing one voter's ballot.
+template<class Rule>
+void CheckWinners(int (*reference_winner)(const Profile&, const int),
+                  const int seed) {
+  mt19937 random(seed);
+  for (int trial = 0; trial < 300; ++trial) {
+    const int num_candidates = 1 + random() % 8;
+    const int num_voters = 1 + random() % 12;
+    Profile profile = bush::reference::RandomProfile(num_candidates,
+                                                     num_voters, &random);
+    const CompactVote vote =
+        bush::reference::ToVote<CompactVote>(profile, num_candidates);
+    PairwiseMatrix matrix(vote);
+    for (int change = 0; change < 2; ++change) {
+      if (change) {
+        const int voter = random() % num_voters;
+        profile[voter] = bush::reference::RandomPreference(num_candidates,
+                                                           &random);
+        const CompactVote changed =
+            bush::reference::ToVote<CompactVote>(profile, num_candidates);
+        matrix.Add(vote.ratings(voter).data(), -1);
+        matrix.Add(changed.ratings(voter).data(), 1);
+      }
+      const vector<int> scores = Rule::Scores(matrix);
+      const int winner = std::max_element(scores.begin(), scores.end()) -
+                         scores.begin();
+      ASSERT_EQ(reference_winner(profile, num_candidates), winner)
+          << "trial " << trial << ", change " << change;
+      for (int c = 0; c < num_candidates; ++c) {
+        ASSERT_EQ(c == winner, Rule::Wins(matrix, c))
+            << "trial " << trial << ", change " << change << ", candidate "
+            << c;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(PairwiseRuleTest, CopelandMatchesReference) {
+  CheckWinners<CopelandRule>(bush::reference::CopelandWinner, 24);
+}
+
+TEST(PairwiseRuleTest, SchulzeMatchesReference) {
+  CheckWinners<SchulzeRule>(bush::reference::SchulzeWinner, 240);
+}
@@ -0,0 +1,55 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "../pairwise-system.h"
+#include "../clock.h"
+#include "../vote.h"
+#include "../voting-system.h"
+#include "./reference.h"
+
+using std::vector;
+using std::mt19937;
+using base::Clock;
+using bush::Copeland;
+using bush::CompactVote;
+using bush::VotingSystem;
+using bush::reference::Profile;
+
+// The voter's most preferred candidate is tried even without time, the
+// gandhi samples may get a deadline below the clock resolution.
+TEST(PairwiseSystemTest, TriesBestCandidateWithoutTime) {
+  mt19937 random(24);
+  VotingSystem::Options options;
+  options.time_limit = 60 * Clock::kMicroInSec;
+  VotingSystem::Options no_time = options;
+  no_time.time_limit = 0;
+  int num_boosted = 0;
+  for (int trial = 0; trial < 300; ++trial) {
+    const int num_candidates = 2 + random() % 6;
+    const int num_voters = 1 + random() % 12;
+    Profile profile = bush::reference::RandomProfile(num_candidates,
+                                                     num_voters, &random);
+    const CompactVote vote =
+        bush::reference::ToVote<CompactVote>(profile, num_candidates);
+    const int voter = random() % num_voters;
+    const vector<int>& sincere = profile[voter];
+    const vector<int> pref = Copeland<CompactVote>(
+        vote, voter, VotingSystem::kSimple, options).strategic_preference();
+    const vector<int> no_time_pref = Copeland<CompactVote>(
+        vote, voter, VotingSystem::kSimple, no_time).strategic_preference();
+    if (pref[0] == sincere[0]) {
+      EXPECT_EQ(pref, no_time_pref) << "trial " << trial;
+      num_boosted += pref != sincere;
+    }
+    const int sincere_winner =
+        bush::reference::CopelandWinner(profile, num_candidates);
+    profile[voter] = no_time_pref;
+    EXPECT_GE(bush::reference::Rating(
+                  sincere, bush::reference::CopelandWinner(profile,
+                                                           num_candidates)),
+              bush::reference::Rating(sincere, sincere_winner))
+        << "trial " << trial;
+  }
+  EXPECT_GT(num_boosted, 0);
+}
@@ -0,0 +1,250 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_TEST_REFERENCE_H_
+#define SRC_TEST_REFERENCE_H_
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace bush {
+namespace reference {
+
+// Naive reference implementations for the tests, written for clarity rather
+// than speed, and seeded random profiles to check against.
+
+typedef std::vector<std::vector<int> > Profile;
+
+// Returns a random preference over the candidates.
+inline std::vector<int> RandomPreference(const int num_candidates,
+                                         std::mt19937* random) {
+  std::vector<int> pref(num_candidates);
+  for (int c = 0; c < num_candidates; ++c) {
+    pref[c] = c;
+  }
+  std::shuffle(pref.begin(), pref.end(), *random);
+  return pref;
+}
+
+// Returns a random profile, most voters share one of a few common ballots so
+// that ballots repeat and tallies tie.
+inline Profile RandomProfile(const int num_candidates, const int num_voters,
+                             std::mt19937* random) {
+  Profile common;
+  for (int i = 0; i < 3; ++i) {
+    common.push_back(RandomPreference(num_candidates, random));
+  }
+  Profile profile;
+  for (int v = 0; v < num_voters; ++v) {
+    if ((*random)() % 5 < 3) {
+      profile.push_back(common[(*random)() % common.size()]);
+    } else {
+      profile.push_back(RandomPreference(num_candidates, random));
+    }
+  }
+  return profile;
+}
+
+// Returns the vote of the profile.
+template<class VoteType>
+VoteType ToVote(const Profile& profile, const int num_candidates) {
+  const int num_voters = profile.size();
+  VoteType vote(num_candidates, num_voters);
+  for (int v = 0; v < num_voters; ++v) {
+    vote.AddPreference(v, profile[v]);
+  }
+  return vote;
+}
+
+// Returns the rating of the candidate in the preference.
+inline int Rating(const std::vector<int>& pref, const int candidate) {
+  const int num_candidates = pref.size();
+  return num_candidates - 1 -
+         (std::find(pref.begin(), pref.end(), candidate) - pref.begin());
+}
+
+// Returns the instant-runoff winner, recounting all preferences each round.
+// A candidate with more than half of the votes wins, otherwise the candidate
+// with the fewest votes is eliminated, the lowest id on ties.
+inline int IrvWinner(const Profile& profile, const int num_candidates) {
+  const int plurality = profile.size() / 2;
+  std::vector<bool> active(num_candidates, true);
+  for (int round = 0; round < num_candidates; ++round) {
+    std::vector<int> tallies(num_candidates, 0);
+    for (auto it = profile.cbegin(), end = profile.cend(); it != end; ++it) {
+      for (auto c = it->cbegin(), c_end = it->cend(); c != c_end; ++c) {
+        if (active[*c]) {
+          ++tallies[*c];
+          break;
+        }
+      }
+    }
+    int eliminated = -1;
+    for (int c = 0; c < num_candidates; ++c) {
+      if (!active[c]) {
+        continue;
+      } else if (tallies[c] > plurality) {
+        return c;
+      } else if (eliminated == -1 || tallies[c] < tallies[eliminated]) {
+        eliminated = c;
+      }
+    }
+    active[eliminated] = false;
+  }
+  return -1;
+}
+
+// Returns the instant-runoff winner with the voter voting the preference.
+inline int IrvWinner(Profile profile, const int num_candidates,
+                     const int voter, const std::vector<int>& pref) {
+  profile[voter] = pref;
+  return IrvWinner(profile, num_candidates);
+}
+
+// Returns the points of each candidate under the positional scoring Rule.
+template<class Rule>
+std::vector<int> ScoringTally(const Profile& profile,
+                              const int num_candidates) {
+  std::vector<int> points(num_candidates, 0);
+  for (auto it = profile.cbegin(), end = profile.cend(); it != end; ++it) {
+    for (int p = 0; p < num_candidates; ++p) {
+      points[(*it)[p]] += Rule::Score(p, num_candidates);
+    }
+  }
+  return points;
+}
+
+// Returns the winner of the positional scoring Rule, the candidate with the
+// most points, the lowest id on ties.
+template<class Rule>
+int ScoringWinner(const Profile& profile, const int num_candidates) {
+  const std::vector<int> points = ScoringTally<Rule>(profile, num_candidates);
+  return std::max_element(points.begin(), points.end()) - points.begin();
+}
+
+// Returns the voter's rating of the scoring winner of the other voters.
+template<class Rule>
+int ScoringUtility(Profile profile, const int num_candidates,
+                   const int voter) {
+  const std::vector<int> pref = profile[voter];
+  profile.erase(profile.begin() + voter);
+  return Rating(pref, ScoringWinner<Rule>(profile, num_candidates));
+}
+
+// Returns the simple strategic preference of the voter under the scoring
+// Rule. A candidate is hopeful if the voter's top score lifts it at least to
+// the points of the other voters' leader. The voter's most preferred hopeful
+// candidate goes first, candidate 0 if the voter rates none above 0. The
+// candidates with the fewest points of the others take the other positions
+// scoring more than the last one, the remaining ones follow by decreasing
+// rating if hopeful, rated 0 otherwise. Ties go to the lowest id.
+template<class Rule>
+std::vector<int> ScoringStrategicPreference(Profile profile,
+                                            const int num_candidates,
+                                            const int voter) {
+  const std::vector<int> pref = profile[voter];
+  profile.erase(profile.begin() + voter);
+  const std::vector<int> points = ScoringTally<Rule>(profile, num_candidates);
+  const int leader_points = *std::max_element(points.begin(), points.end());
+  const int max_lift = Rule::Score(0, num_candidates) -
+                       Rule::Score(num_candidates - 1, num_candidates);
+  std::vector<int> hopes(num_candidates);
+  int best = 0;
+  for (int c = 0; c < num_candidates; ++c) {
+    hopes[c] = leader_points - points[c] <= max_lift ? Rating(pref, c) : 0;
+    if (hopes[c] > hopes[best]) {
+      best = c;
+    }
+  }
+  std::vector<int> others;
+  for (int c = 0; c < num_candidates; ++c) {
+    if (c != best) {
+      others.push_back(c);
+    }
+  }
+  std::sort(others.begin(), others.end(), [&points](const int a,
+                                                    const int b) {
+    return points[a] < points[b] || (points[a] == points[b] && a < b);
+  });
+  int num_scoring = 0;
+  for (int p = 1; p < num_candidates; ++p) {
+    num_scoring += Rule::Score(p, num_candidates) >
+                   Rule::Score(num_candidates - 1, num_candidates);
+  }
+  std::sort(others.begin() + num_scoring, others.end(),
+            [&hopes](const int a, const int b) {
+    return hopes[a] > hopes[b] || (hopes[a] == hopes[b] && a < b);
+  });
+  std::vector<int> strategic_pref(1, best);
+  strategic_pref.insert(strategic_pref.end(), others.begin(), others.end());
+  return strategic_pref;
+}
+
+// Returns the number of voters ranking candidate i above candidate j.
+inline int PairwiseWins(const Profile& profile, const int i, const int j) {
+  int wins = 0;
+  for (auto it = profile.cbegin(), end = profile.cend(); it != end; ++it) {
+    wins += Rating(*it, i) > Rating(*it, j);
+  }
+  return wins;
+}
+
+// Returns the Copeland winner, the candidate with the most pairwise majority
+// wins, ties counting half, the lowest id on ties.
+inline int CopelandWinner(const Profile& profile, const int num_candidates) {
+  int winner = 0;
+  int winner_score = -1;
+  for (int i = 0; i < num_candidates; ++i) {
+    int score = 0;
+    for (int j = 0; j < num_candidates; ++j) {
+      if (i != j) {
+        const int wins = PairwiseWins(profile, i, j);
+        const int losses = PairwiseWins(profile, j, i);
+        score += wins > losses ? 2 : wins == losses;
+      }
+    }
+    if (score > winner_score) {
+      winner = i;
+      winner_score = score;
+    }
+  }
+  return winner;
+}
+
+// Returns the Schulze winner, the lowest candidate whose widest paths of
+// majority wins to all others are at least as wide as the ones back.
+inline int SchulzeWinner(const Profile& profile, const int num_candidates) {
+  std::vector<std::vector<int> > paths(num_candidates,
+                                       std::vector<int>(num_candidates, 0));
+  for (int i = 0; i < num_candidates; ++i) {
+    for (int j = 0; j < num_candidates; ++j) {
+      const int wins = PairwiseWins(profile, i, j);
+      if (i != j && wins > PairwiseWins(profile, j, i)) {
+        paths[i][j] = wins;
+      }
+    }
+  }
+  for (int k = 0; k < num_candidates; ++k) {
+    for (int i = 0; i < num_candidates; ++i) {
+      for (int j = 0; j < num_candidates; ++j) {
+        if (i != j && i != k && j != k) {
+          paths[i][j] = std::max(paths[i][j],
+                                 std::min(paths[i][k], paths[k][j]));
+        }
+      }
+    }
+  }
+  for (int i = 0; i < num_candidates; ++i) {
+    bool beaten = false;
+    for (int j = 0; j < num_candidates; ++j) {
+      beaten |= paths[j][i] > paths[i][j];
+    }
+    if (!beaten) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+}  // namespace reference
+}  // namespace bush
+#endif  // SRC_TEST_REFERENCE_H_
@@ -0,0 +1,85 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "../score-kernel.h"
+
+using std::vector;
+using std::mt19937;
+using bush::ScoreKernel;
+
+namespace {
+
+// Sizes with remainders after the 16, 8 and 4 lane loops.
+const int kSizes[] = {1, 3, 5, 7, 9, 13, 15, 17, 23, 31, 33, 37, 100, 257};
+
+// Accumulates random rows with random weights, including weights overflowing
+// the scores, with each instruction set up to the detected one and compares
+// the scores with the ones of the scalar path.
+template<typename Row, typename Score>
+void CheckAccumulate(const uint32_t max_row, const int seed) {
+  const ScoreKernel::Isa detected = ScoreKernel::DetectIsa();
+  const ScoreKernel::Isa original = ScoreKernel::isa();
+  mt19937 random(seed);
+  for (auto size_it = std::begin(kSizes), size_end = std::end(kSizes);
+       size_it != size_end; ++size_it) {
+    const int size = *size_it;
+    vector<vector<Row> > rows(20, vector<Row>(size));
+    vector<Score> weights(rows.size());
+    for (size_t r = 0; r < rows.size(); ++r) {
+      for (int c = 0; c < size; ++c) {
+        rows[r][c] = random() % (max_row + 1);
+      }
+      weights[r] = r % 4 ? random() % 100 : random();
+    }
+    vector<Score> expected(size, 0);
+    ScoreKernel::set_isa(ScoreKernel::kScalar);
+    for (size_t r = 0; r < rows.size(); ++r) {
+      ScoreKernel::Accumulate(rows[r].data(), weights[r], size,
+                              expected.data());
+    }
+    for (int isa = ScoreKernel::kSse4; isa <= detected; ++isa) {
+      ScoreKernel::set_isa(static_cast<ScoreKernel::Isa>(isa));
+      vector<Score> scores(size, 0);
+      for (size_t r = 0; r < rows.size(); ++r) {
+        ScoreKernel::Accumulate(rows[r].data(), weights[r], size,
+                                scores.data());
+      }
+      EXPECT_EQ(expected, scores)
+          << ScoreKernel::IsaName(ScoreKernel::isa()) << ", size " << size;
+    }
+  }
+  ScoreKernel::set_isa(original);
+}
+
+}  // namespace
+
+TEST(ScoreKernelTest, ScalarPath) {
+  // The scalar path against a naive loop on wrapping 16-bit scores.
+  const ScoreKernel::Isa original = ScoreKernel::isa();
+  ScoreKernel::set_isa(ScoreKernel::kScalar);
+  const vector<uint16_t> row = {0, 1, 2, 65535, 300};
+  vector<uint16_t> scores = {1, 2, 3, 4, 65535};
+  ScoreKernel::Accumulate(row.data(), uint16_t(300), row.size(),
+                          scores.data());
+  EXPECT_EQ(vector<uint16_t>({1, 302, 603, uint16_t(4 - 300),
+                              uint16_t(65535 + 90000)}), scores);
+  ScoreKernel::set_isa(original);
+}
+
+TEST(ScoreKernelTest, Uint16Rows16BitScores) {
+  CheckAccumulate<uint16_t, uint16_t>(255, 11);
+}
+
+TEST(ScoreKernelTest, Uint16Rows32BitScores) {
+  CheckAccumulate<uint16_t, uint32_t>(255, 12);
+}
+
+TEST(ScoreKernelTest, IntRows16BitScores) {
+  CheckAccumulate<int, uint16_t>(1000, 13);
+}
+
+TEST(ScoreKernelTest, IntRows32BitScores) {
+  CheckAccumulate<int, uint32_t>(1000, 14);
+}
@@ -0,0 +1,131 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "../scoring-rule.h"
+#include "../scoring-system.h"
+#include "../vote.h"
+#include "../voting-system.h"
+#include "./reference.h"
+
+using std::vector;
+using std::mt19937;
+using bush::ScoringSystem;
+using bush::PluralityRule;
+using bush::BordaRule;
+using bush::VetoRule;
+using bush::ApprovalRule;
+using bush::Vote;
+using bush::CompactVote;
+using bush::VotingSystem;
+using bush::reference::Profile;
+
+namespace {
+
+// A scoring rule and the vote type of the preferences.
+template<class RuleType, class VoteType>
+struct ScoringCase {
+  typedef RuleType Rule;
+  typedef VoteType Vote;
+  typedef ScoringSystem<RuleType, VoteType> System;
+};
+
+// Returns a random profile of up to max_candidates candidates.
+Profile RandomProfile(const int max_candidates, const int max_voters,
+                      mt19937* random, int* num_candidates) {
+  *num_candidates = 1 + (*random)() % max_candidates;
+  const int num_voters = 1 + (*random)() % max_voters;
+  return bush::reference::RandomProfile(*num_candidates, num_voters, random);
+}
+
+}  // namespace
+
+template<class Case>
+class ScoringSystemTest : public testing::Test {};
+
+typedef testing::Types<ScoringCase<PluralityRule, Vote>,
+                       ScoringCase<PluralityRule, CompactVote>,
+                       ScoringCase<BordaRule, Vote>,
+                       ScoringCase<BordaRule, CompactVote>,
+                       ScoringCase<VetoRule, Vote>,
+                       ScoringCase<VetoRule, CompactVote>,
+                       ScoringCase<ApprovalRule<2>, Vote>,
+                       ScoringCase<ApprovalRule<2>, CompactVote>,
+                       ScoringCase<ApprovalRule<3>, Vote>,
+                       ScoringCase<ApprovalRule<3>, CompactVote> > Cases;
+TYPED_TEST_SUITE(ScoringSystemTest, Cases);
+
+TYPED_TEST(ScoringSystemTest, TallyMatchesReference) {
+  typedef typename TypeParam::Rule Rule;
+  typedef typename TypeParam::Vote VoteType;
+  typedef typename TypeParam::System System;
+  mt19937 random(23);
+  for (int trial = 0; trial < 300; ++trial) {
+    int num_candidates = 0;
+    const Profile profile = RandomProfile(9, 30, &random, &num_candidates);
+    EXPECT_EQ(bush::reference::ScoringTally<Rule>(profile, num_candidates),
+              System::Tally(bush::reference::ToVote<VoteType>(
+                  profile, num_candidates)))
+        << "trial " << trial;
+  }
+  // Borda ratings beyond 16 bits and, for Vote, beyond the one byte ids.
+  const int sizes[][2] = {{10, 20000}, {300, 50}};
+  for (int i = 0; i < 2; ++i) {
+    const int num_candidates = sizes[i][0];
+    if (num_candidates > VoteType::MaxCandidates()) {
+      continue;
+    }
+    const Profile profile = bush::reference::RandomProfile(
+        num_candidates, sizes[i][1], &random);
+    EXPECT_EQ(bush::reference::ScoringTally<Rule>(profile, num_candidates),
+              System::Tally(bush::reference::ToVote<VoteType>(
+                  profile, num_candidates)))
+        << num_candidates << " candidates";
+  }
+}
+
+TYPED_TEST(ScoringSystemTest, UtilityMatchesReference) {
+  typedef typename TypeParam::Rule Rule;
+  typedef typename TypeParam::Vote VoteType;
+  typedef typename TypeParam::System System;
+  mt19937 random(230);
+  for (int trial = 0; trial < 300; ++trial) {
+    int num_candidates = 0;
+    const Profile profile = RandomProfile(9, 30, &random, &num_candidates);
+    const VoteType vote = bush::reference::ToVote<VoteType>(profile,
+                                                            num_candidates);
+    const vector<int> tally = System::Tally(vote);
+    const int voter = random() % profile.size();
+    const int expected = bush::reference::ScoringUtility<Rule>(
+        profile, num_candidates, voter);
+    EXPECT_EQ(expected, System::Utility(vote, voter)) << "trial " << trial;
+    EXPECT_EQ(expected, System::Utility(vote, tally, voter))
+        << "trial " << trial;
+  }
+}
+
+TYPED_TEST(ScoringSystemTest, StrategicPreferenceMatchesReference) {
+  typedef typename TypeParam::Rule Rule;
+  typedef typename TypeParam::Vote VoteType;
+  typedef typename TypeParam::System System;
+  mt19937 random(2300);
+  const VotingSystem::Options options;
+  for (int trial = 0; trial < 300; ++trial) {
+    int num_candidates = 0;
+    const Profile profile = RandomProfile(9, 30, &random, &num_candidates);
+    const VoteType vote = bush::reference::ToVote<VoteType>(profile,
+                                                            num_candidates);
+    const int voter = random() % profile.size();
+    const vector<int> expected =
+        bush::reference::ScoringStrategicPreference<Rule>(
+            profile, num_candidates, voter);
+    EXPECT_EQ(expected,
+              System(vote, voter, VotingSystem::kSimple, options)
+                  .strategic_preference())
+        << "trial " << trial;
+    EXPECT_EQ(expected,
+              System(vote, VotingSystem::kSimple, options)
+                  .StrategicPreference(voter))
+        << "trial " << trial;
+  }
+}
@@ -0,0 +1,134 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_THREAD_POOL_H_
+#define SRC_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace base {
+
+// Fixed-size pool of worker threads executing scheduled tasks.
+// A pool of size 1 has no workers and executes all tasks on the calling
+// thread, which keeps single-threaded runs free of synchronisation.
+class ThreadPool {
+ public:
+  typedef std::function<void()> Task;
+
+  // Returns the number of hardware threads, at least 1.
+  static int NumHardwareThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Initialises the pool with given number of threads, the calling thread
+  // counts as one of them.
+  explicit ThreadPool(const int num_threads)
+      : num_threads_(std::max(1, num_threads)),
+        num_pending_(0),
+        stop_(false) {
+    for (int i = 1; i < num_threads_; ++i) {
+      workers_.push_back(std::thread(&ThreadPool::Work, this));
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    task_cond_.notify_all();
+    for (auto it = workers_.begin(), end = workers_.end(); it != end; ++it) {
+      it->join();
+    }
+  }
+
+  // Schedules the task for execution by one of the workers.
+  void Schedule(const Task& task) {
+    if (workers_.empty()) {
+      task();
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(task);
+      ++num_pending_;
+    }
+    task_cond_.notify_one();
+  }
+
+  // Blocks until all scheduled tasks are completed.
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cond_.wait(lock, [this] { return num_pending_ == 0; });
+  }
+
+  // Calls func(i) for each i in [beg, end) using all threads of the pool and
+  // returns once all calls are completed. Indices are handed out dynamically,
+  // the order of execution is unspecified.
+  template<typename Func>
+  void ParallelFor(const int beg, const int end, const Func& func) {
+    if (workers_.empty()) {
+      for (int i = beg; i < end; ++i) {
+        func(i);
+      }
+      return;
+    }
+    std::atomic<int> next(beg);
+    auto worker = [&next, end, &func] {
+      for (int i = next++; i < end; i = next++) {
+        func(i);
+      }
+    };
+    for (int t = 1; t < num_threads_; ++t) {
+      Schedule(worker);
+    }
+    // The calling thread works too.
+    worker();
+    Wait();
+  }
+
+  int num_threads() const {
+    return num_threads_;
+  }
+
+ private:
+  void Work() {
+    while (true) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        task_cond_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          // Stopped.
+          return;
+        }
+        task = tasks_.front();
+        tasks_.pop_front();
+      }
+      task();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--num_pending_ == 0) {
+          done_cond_.notify_all();
+        }
+      }
+    }
+  }
+
+  const int num_threads_;
+  std::vector<std::thread> workers_;
+  std::deque<Task> tasks_;
+  std::mutex mutex_;
+  std::condition_variable task_cond_;
+  std::condition_variable done_cond_;
+  int num_pending_;
+  bool stop_;
+};
+
+}  // namespace base
+#endif  // SRC_THREAD_POOL_H_
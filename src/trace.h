@@ -0,0 +1,172 @@
+// Copyright 2012 Eugen Sawin <esawin@me73.com>
+#ifndef SRC_TRACE_H_
+#define SRC_TRACE_H_
+
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "./clock.h"
+
+namespace base {
+
+// Process-wide tracing of scoped spans in the Chrome trace event format,
+// which is read by chrome://tracing and Perfetto. Each thread records its
+// spans into its own ring buffer, which keeps the most recent events and
+// needs no locks; only the first span of a thread registers its buffer.
+// Tracing is disabled until Enable is called, then a span costs two clock
+// reads.
+class Trace {
+ public:
+  // Default number of events kept per thread.
+  static const size_t kDefCapacity = 1 << 16;
+  // Argument value of spans without an argument.
+  static const int64_t kNoArg = -1;
+
+  // Records the wall-clock time from construction to destruction as span of
+  // given name, which must be a string literal. The optional argument, e.g.
+  // a voter or chunk id, is shown with the span.
+  class Span {
+   public:
+    explicit Span(const char* name, const int64_t arg = kNoArg)
+        : name_(name),
+          arg_(arg),
+          recorded_(enabled()),
+          beg_(recorded_ ? Now() : 0) {}
+
+    ~Span() {
+      if (recorded_) {
+        Record(name_, arg_, beg_, Now());
+      }
+    }
+
+   private:
+    const char* name_;
+    int64_t arg_;
+    bool recorded_;
+    Clock::Diff beg_;
+  };
+
+  // Starts the tracing with given number of events kept per thread. Spans
+  // begun before are not recorded.
+  static void Enable(const size_t capacity = kDefCapacity) {
+    Registry& registry = Instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.capacity = capacity ? capacity : 1;
+    registry.enabled.store(true, std::memory_order_release);
+  }
+
+  static bool enabled() {
+    return Instance().enabled.load(std::memory_order_relaxed);
+  }
+
+  // Writes the recorded spans of all threads as trace JSON to the file at
+  // given path. Returns false if the file could not be written. Must not be
+  // called while spans are recorded.
+  static bool Dump(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+      return false;
+    }
+    Registry& registry = Instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const int pid = getpid();
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    bool first = true;
+    for (size_t tid = 0; tid < registry.buffers.size(); ++tid) {
+      const Buffer& buffer = *registry.buffers[tid];
+      fprintf(file, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                    "\"pid\": %d, \"tid\": %zu, \"args\": {\"name\": "
+                    "\"thread %zu\"}}", first ? "" : ",", pid, tid, tid);
+      first = false;
+      // The oldest event is next to be overwritten once the ring is full.
+      const size_t size = buffer.events.size();
+      const size_t oldest = buffer.num_events > size ?
+                            buffer.num_events % size : 0;
+      for (size_t i = 0; i < size; ++i) {
+        const Event& event = buffer.events[(oldest + i) % size];
+        fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, "
+                      "\"tid\": %zu, \"ts\": %lld, \"dur\": %lld",
+                event.name, pid, tid, static_cast<long long>(event.beg),
+                static_cast<long long>(event.end - event.beg));
+        if (event.arg != kNoArg) {
+          fprintf(file, ", \"args\": {\"id\": %lld}",
+                  static_cast<long long>(event.arg));
+        }
+        fprintf(file, "}");
+      }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+  }
+
+ private:
+  struct Event {
+    const char* name;
+    int64_t arg;
+    Clock::Diff beg;
+    Clock::Diff end;
+  };
+
+  // Ring buffer of a thread, growing up to its capacity, num_events counts
+  // all events ever recorded.
+  struct Buffer {
+    explicit Buffer(const size_t capacity)
+        : capacity(capacity),
+          num_events(0) {}
+
+    size_t capacity;
+    std::vector<Event> events;
+    size_t num_events;
+  };
+
+  // The buffers outlive their threads, so spans of finished worker threads
+  // are dumped too.
+  struct Registry {
+    Registry()
+        : enabled(false),
+          capacity(kDefCapacity),
+          epoch(Clock::kRealMonotonic) {}
+
+    std::atomic<bool> enabled;
+    std::mutex mutex;
+    size_t capacity;
+    Clock epoch;
+    std::vector<std::unique_ptr<Buffer> > buffers;
+  };
+
+  static Registry& Instance() {
+    static Registry registry;
+    return registry;
+  }
+
+  // Returns the time in microseconds since the registry's creation.
+  static Clock::Diff Now() {
+    return Clock(Clock::kRealMonotonic) - Instance().epoch;
+  }
+
+  static void Record(const char* name, const int64_t arg,
+                     const Clock::Diff beg, const Clock::Diff end) {
+    static thread_local Buffer* buffer = nullptr;
+    if (!buffer) {
+      Registry& registry = Instance();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.buffers.emplace_back(new Buffer(registry.capacity));
+      buffer = registry.buffers.back().get();
+    }
+    const Event event = {name, arg, beg, end};
+    if (buffer->events.size() < buffer->capacity) {
+      buffer->events.push_back(event);
+    } else {
+      buffer->events[buffer->num_events % buffer->capacity] = event;
+    }
+    ++buffer->num_events;
+  }
+};
+
+}  // namespace base
+#endif  // SRC_TRACE_H_
@@ -1,77 +1,299 @@
 // Copyright 2012 Eugen Sawin <esawin@me73.com>
 #include "./vote.h"
 #include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 using std::vector;
 using std::string;
 using std::ostringstream;
+using std::copy;
+using std::equal;
+using std::numeric_limits;
 
 namespace bush {
 
-Vote::Vote(const int num_candidates, const int num_voters)
-    : preferences_(num_voters),
-      ratings_(num_voters, vector<int>(num_candidates, 0)),
+template<typename Id, typename Rating>
+const int BasicVote<Id, Rating>::kInvalidBallot;
+
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::MaxCandidates() {
+  const int64_t max_id = numeric_limits<Id>::max();
+  const int64_t max_rating = numeric_limits<Rating>::max();
+  return std::min<int64_t>(numeric_limits<int>::max(),
+                           std::min(max_id, max_rating) + 1);
+}
+
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::MaxVoters(const int num_candidates) {
+  return numeric_limits<int>::max() / std::max(1, num_candidates - 1);
+}
+
+template<typename Id, typename Rating>
+BasicVote<Id, Rating>::BasicVote(const int num_candidates,
+                                 const int num_voters)
+    : voter_ballots_(num_voters, kInvalidBallot),
+      index_(16, kInvalidBallot),
+      pref_(num_candidates),
       num_candidates_(num_candidates),
-      num_voters_(num_voters) {}
+      num_voters_(num_voters),
+      num_ballots_(0) {
+  assert(num_candidates <= MaxCandidates());
+  assert(num_voters <= MaxVoters(num_candidates));
+}
 
-void Vote::AddPreference(const int voter_id, const vector<int>& pref) {
-  assert(voter_id >= 0 && voter_id < num_voters());
-  assert(static_cast<int>(pref.size()) == num_candidates());
-  UpdateRatings(voter_id, pref);
-  preferences_[voter_id] = pref;
+template<typename Id, typename Rating>
+void BasicVote<Id, Rating>::AddPreference(const int voter_id,
+                                          const vector<int>& pref) {
+  AssignBallot(voter_id, AddBallot(pref));
 }
 
-void Vote::AddPreference(const int voter_id, vector<int>&& pref) {
+template<typename Id, typename Rating>
+void BasicVote<Id, Rating>::AddPreference(const int voter_id,
+                                          const Row& pref) {
   assert(voter_id >= 0 && voter_id < num_voters());
   assert(static_cast<int>(pref.size()) == num_candidates());
-  UpdateRatings(voter_id, pref);
-  preferences_[voter_id].swap(pref);
+  AssignBallot(voter_id, AddBallot(pref));
 }
 
-const vector<int>& Vote::preference(const int voter_id) const {
-  assert(voter_id >= 0 && voter_id < num_voters());
-  return preferences_[voter_id];
+template<typename Id, typename Rating>
+typename BasicVote<Id, Rating>::Row
+BasicVote<Id, Rating>::preference(const int voter_id) const {
+  return ballot(voter_ballot(voter_id));
 }
 
-const vector<int>& Vote::ratings(const int voter_id) const {
-  assert(voter_id >= 0 && voter_id < num_voters());
-  return ratings_[voter_id];
+template<typename Id, typename Rating>
+typename BasicVote<Id, Rating>::RatingRow
+BasicVote<Id, Rating>::ratings(const int voter_id) const {
+  return ballot_ratings(voter_ballot(voter_id));
 }
 
-int Vote::num_candidates() const {
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::num_candidates() const {
   return num_candidates_;
 }
 
-int Vote::num_voters() const {
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::num_voters() const {
   return num_voters_;
 }
 
-string Vote::str() const {
+template<typename Id, typename Rating>
+string BasicVote<Id, Rating>::str() const {
   ostringstream ss;
   ss << num_candidates() << " " << num_voters() << "\n";
-  for (auto it = preferences_.cbegin(), end = preferences_.cend();
-       it != end; ++it) {
-    const vector<int>& voter_pref = *it;
-    for (auto it2 = voter_pref.cbegin(), end2 = voter_pref.cend();
-         it2 != end2; ++it2) {
-      if (it2 != voter_pref.cbegin()) {
+  for (int v = 0; v < num_voters_; ++v) {
+    const Row voter_pref = preference(v);
+    for (auto it = voter_pref.begin(), end = voter_pref.end();
+         it != end; ++it) {
+      if (it != voter_pref.begin()) {
         ss << " ";
       }
-      ss << *it2;
+      ss << static_cast<int>(*it);
     }
     ss << "\n";
   }
   return ss.str();
 }
 
-void Vote::UpdateRatings(const int voter_id, const vector<int>& pref) {
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::AddBallot(const Row& pref) {
+  assert(static_cast<int>(pref.size()) == num_candidates());
+  if (index_.empty()) {
+    size_t size = 16;
+    while (size < 2 * (static_cast<size_t>(num_ballots_) + 1)) {
+      size *= 2;
+    }
+    Rehash(size);
+  }
+  const size_t hash = Hash(pref);
+  const size_t slot = FindBallot(pref, hash);
+  if (index_[slot] != kInvalidBallot) {
+    // Known ballot.
+    return index_[slot];
+  }
+  const int ballot_id = num_ballots_++;
+  index_[slot] = ballot_id;
+  ballots_.insert(ballots_.end(), pref.begin(), pref.end());
+  ratings_.resize(ballots_.size(), 0);
+  counts_.push_back(0);
+  UpdateRatings(ballot_id, pref);
+  if (2 * static_cast<size_t>(num_ballots_) > index_.size()) {
+    // Keep the load factor below 0.5 to bound the probe sequences.
+    Rehash(2 * index_.size());
+  }
+  return ballot_id;
+}
+
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::AddBallot(const vector<int>& pref) {
+  assert(static_cast<int>(pref.size()) == num_candidates());
+  copy(pref.begin(), pref.end(), pref_.begin());
+  return AddBallot(Row(pref_.data(), pref_.size()));
+}
+
+template<typename Id, typename Rating>
+void BasicVote<Id, Rating>::AssignBallot(const int voter_id,
+                                         const int ballot_id) {
+  assert(voter_id >= 0 && voter_id < num_voters());
+  assert(ballot_id >= 0 && ballot_id < num_ballots());
+  int& voter_ballot = voter_ballots_[voter_id];
+  if (voter_ballot != kInvalidBallot) {
+    // Voter changes its preference.
+    --counts_[voter_ballot];
+  }
+  voter_ballot = ballot_id;
+  ++counts_[ballot_id];
+}
+
+template<typename Id, typename Rating>
+void BasicVote<Id, Rating>::AddVote(const int first_voter,
+                                    const BasicVote& part) {
+  assert(part.num_candidates() == num_candidates());
+  assert(first_voter >= 0 && first_voter + part.num_voters() <= num_voters());
+  const int num_part_ballots = part.num_ballots();
+  vector<int> ballot_ids(num_part_ballots);
+  for (int b = 0; b < num_part_ballots; ++b) {
+    ballot_ids[b] = AddBallot(part.ballot(b));
+  }
+  const int num_part_voters = part.num_voters();
+  for (int v = 0; v < num_part_voters; ++v) {
+    AssignBallot(first_voter + v, ballot_ids[part.voter_ballot(v)]);
+  }
+}
+
+template<typename Id, typename Rating>
+template<typename StoredId>
+bool BasicVote<Id, Rating>::AddDistinctBallots(const StoredId* ids,
+                                               const int num_ballots,
+                                               const uint32_t* counts,
+                                               const uint32_t* voter_ballots) {
+  assert(num_ballots_ == 0);
+  const size_t size = static_cast<size_t>(num_ballots) * num_candidates_;
+  ballots_.resize(size);
+  // Unset ratings are marked by num_candidates, which detects repeated ids.
+  ratings_.assign(size, num_candidates_);
+  for (size_t row = 0; row < size; row += num_candidates_) {
+    Rating* ratings = ratings_.data() + row;
+    for (int i = 0; i < num_candidates_; ++i) {
+      const int id = ids[row + i];
+      if (id >= num_candidates_ ||
+          ratings[id] != static_cast<Rating>(num_candidates_)) {
+        return false;
+      }
+      ballots_[row + i] = id;
+      ratings[id] = num_candidates_ - i - 1;
+    }
+  }
+  counts_.assign(counts, counts + num_ballots);
+  voter_ballots_.assign(voter_ballots, voter_ballots + num_voters_);
+  num_ballots_ = num_ballots;
+  // The ballots are indexed on the next AddBallot.
+  index_.clear();
+  return true;
+}
+
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::num_ballots() const {
+  return num_ballots_;
+}
+
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::voter_ballot(const int voter_id) const {
   assert(voter_id >= 0 && voter_id < num_voters());
+  assert(voter_ballots_[voter_id] != kInvalidBallot);
+  return voter_ballots_[voter_id];
+}
+
+template<typename Id, typename Rating>
+int BasicVote<Id, Rating>::count(const int ballot_id) const {
+  assert(ballot_id >= 0 && ballot_id < num_ballots());
+  return counts_[ballot_id];
+}
+
+template<typename Id, typename Rating>
+typename BasicVote<Id, Rating>::Row
+BasicVote<Id, Rating>::ballot(const int ballot_id) const {
+  assert(ballot_id >= 0 && ballot_id < num_ballots());
+  return Row(ballots_.data() + static_cast<size_t>(ballot_id) * num_candidates_,
+             num_candidates_);
+}
+
+template<typename Id, typename Rating>
+typename BasicVote<Id, Rating>::Row BasicVote<Id, Rating>::ballots() const {
+  return Row(ballots_.data(), ballots_.size());
+}
+
+template<typename Id, typename Rating>
+typename BasicVote<Id, Rating>::RatingRow
+BasicVote<Id, Rating>::ballot_ratings(const int ballot_id) const {
+  assert(ballot_id >= 0 && ballot_id < num_ballots());
+  return RatingRow(ratings_.data() +
+                   static_cast<size_t>(ballot_id) * num_candidates_,
+                   num_candidates_);
+}
+
+template<typename Id, typename Rating>
+size_t BasicVote<Id, Rating>::Hash(const Row& pref) {
+  // FNV-1a over the candidate ids.
+  uint64_t h = 14695981039346656037ULL;
+  for (auto it = pref.begin(), end = pref.end(); it != end; ++it) {
+    h = (h ^ static_cast<uint32_t>(*it)) * 1099511628211ULL;
+  }
+  return h ^ (h >> 32);
+}
+
+template<typename Id, typename Rating>
+size_t BasicVote<Id, Rating>::FindBallot(const Row& pref,
+                                         const size_t hash) const {
+  const size_t mask = index_.size() - 1;
+  size_t pos = hash & mask;
+  while (index_[pos] != kInvalidBallot) {
+    const Row known = ballot(index_[pos]);
+    if (equal(known.begin(), known.end(), pref.begin())) {
+      break;
+    }
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+template<typename Id, typename Rating>
+void BasicVote<Id, Rating>::Rehash(const size_t size) {
+  index_.assign(size, kInvalidBallot);
+  for (int b = 0; b < num_ballots_; ++b) {
+    const Row pref = ballot(b);
+    index_[FindBallot(pref, Hash(pref))] = b;
+  }
+}
+
+template<typename Id, typename Rating>
+void BasicVote<Id, Rating>::UpdateRatings(const int ballot_id,
+                                          const Row& pref) {
+  assert(ballot_id >= 0 && ballot_id < num_ballots());
   assert(static_cast<int>(pref.size()) == num_candidates());
-  vector<int>& ratings = ratings_[voter_id];
+  Rating* ratings = ratings_.data() +
+                    static_cast<size_t>(ballot_id) * num_candidates_;
   for (int i = 0; i < num_candidates_; ++i) {
-    ratings[pref[i]] += num_candidates_ - i - 1;
+    ratings[pref[i]] = num_candidates_ - i - 1;
   }
 }
 
+template class BasicVote<int, int>;
+template class BasicVote<uint8_t, uint16_t>;
+template bool BasicVote<int, int>::AddDistinctBallots(
+    const uint8_t* ids, const int num_ballots, const uint32_t* counts,
+    const uint32_t* voter_ballots);
+template bool BasicVote<int, int>::AddDistinctBallots(
+    const uint16_t* ids, const int num_ballots, const uint32_t* counts,
+    const uint32_t* voter_ballots);
+template bool BasicVote<uint8_t, uint16_t>::AddDistinctBallots(
+    const uint8_t* ids, const int num_ballots, const uint32_t* counts,
+    const uint32_t* voter_ballots);
+template bool BasicVote<uint8_t, uint16_t>::AddDistinctBallots(
+    const uint16_t* ids, const int num_ballots, const uint32_t* counts,
+    const uint32_t* voter_ballots);
+
 }  // namespace bush
@@ -2,30 +2,99 @@
 #ifndef SRC_VOTE_H_
 #define SRC_VOTE_H_
 
+#include <cstdint>
 #include <vector>
 #include <string>
+#include "./span.h"
 
 namespace bush {
 
-class Vote {
+// Weighted preference profile. Identical preferences are collapsed into a
+// single ballot with a multiplicity count, each voter refers to its ballot.
+// Candidate ids are stored as Id and ratings as Rating, both have to hold
+// values up to num_candidates - 1.
+template<typename Id, typename Rating>
+class BasicVote {
  public:
-  Vote(const int num_candidates, const int num_voters);
+  typedef Id IdType;
+  typedef Rating RatingType;
+  // Read-only view of a single ballot's row.
+  typedef base::Span<const Id> Row;
+  // Read-only view of a single ballot's ratings.
+  typedef base::Span<const Rating> RatingRow;
+
+  static const int kInvalidBallot = -1;
+
+  // Returns the maximum number of candidates representable.
+  static int MaxCandidates();
+  // Returns the maximum number of voters for the number of candidates, for
+  // which the sum of all voters' ratings of a candidate fits into an int.
+  static int MaxVoters(const int num_candidates);
+
+  BasicVote(const int num_candidates, const int num_voters);
   void AddPreference(const int voter_id, const std::vector<int>& pref);
-  void AddPreference(const int voter_id, std::vector<int>&& pref);
-  const std::vector<int>& preference(const int voter_id) const;
-  const std::vector<int>& ratings(const int voter_id) const;
+  void AddPreference(const int voter_id, const Row& pref);
+  Row preference(const int voter_id) const;
+  RatingRow ratings(const int voter_id) const;
   int num_candidates() const;
   int num_voters() const;
   std::string str() const;
 
+  // Returns the id of the given preference's ballot, adds a new ballot with
+  // zero count if the preference is not known yet.
+  int AddBallot(const Row& pref);
+  int AddBallot(const std::vector<int>& pref);
+  // Assigns the given voter to the ballot.
+  void AssignBallot(const int voter_id, const int ballot_id);
+  // Adds the voters of the given partial vote as voters
+  // [first_voter, first_voter + part.num_voters()).
+  void AddVote(const int first_voter, const BasicVote& part);
+  // Fills the empty vote with the row-major num_ballots x num_candidates
+  // matrix of stored candidate ids, taken as distinct ballots with given
+  // counts, and assigns each voter to its ballot index. The ballots are not
+  // hashed, the counts have to match the voters and the indices have to be in
+  // range. Returns false if a ballot is not a permutation of the candidates.
+  template<typename StoredId>
+  bool AddDistinctBallots(const StoredId* ids, const int num_ballots,
+                          const uint32_t* counts,
+                          const uint32_t* voter_ballots);
+  // Returns the number of distinct ballots.
+  int num_ballots() const;
+  // Returns the ballot id of the given voter.
+  int voter_ballot(const int voter_id) const;
+  // Returns the number of voters sharing the given ballot.
+  int count(const int ballot_id) const;
+  Row ballot(const int ballot_id) const;
+  // Returns the row-major num_ballots x num_candidates matrix of all ballots.
+  Row ballots() const;
+  RatingRow ballot_ratings(const int ballot_id) const;
+
  private:
-  void UpdateRatings(const int voter_id, const std::vector<int>& pref);
+  static size_t Hash(const Row& pref);
+  size_t FindBallot(const Row& pref, const size_t hash) const;
+  void Rehash(const size_t size);
+  void UpdateRatings(const int ballot_id, const Row& pref);
 
-  std::vector<std::vector<int> > preferences_;
-  std::vector<std::vector<int> > ratings_;
+  // Row-major num_ballots x num_candidates matrices.
+  std::vector<Id> ballots_;
+  std::vector<Rating> ratings_;
+  std::vector<int> counts_;
+  std::vector<int> voter_ballots_;
+  // Open-addressing hash index of the ballot ids, used to find duplicates.
+  // It is empty until the first AddBallot after AddDistinctBallots.
+  std::vector<int> index_;
+  // Conversion buffer for preferences given as int vectors.
+  std::vector<Id> pref_;
   int num_candidates_;
   int num_voters_;
+  int num_ballots_;
 };
 
+// Vote with int candidate ids and ratings, for any number of candidates.
+typedef BasicVote<int, int> Vote;
+// Vote with one byte per candidate id, for up to MaxCandidates() = 256
+// candidates.
+typedef BasicVote<uint8_t, uint16_t> CompactVote;
+
 }  // namespace bush
 #endif  // SRC_VOTE_H_
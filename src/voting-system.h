@@ -10,6 +10,25 @@ class VotingSystem {
  public:
   static const base::Clock::Diff kDefTimeLimit = 10 * base::Clock::kMicroInSec;
   enum Strategy { kSimple, kComplete, kIndependent };
+
+  // Settings of the strategic preference computation.
+  struct Options {
+    Options()
+        : num_threads(1),
+          time_limit(kDefTimeLimit),
+          clock_type(base::Clock::kThreadCpuTime),
+          exact(false) {}
+
+    // Number of threads used by the nixon and gandhi strategies.
+    int num_threads;
+    // Time limit of the computation in microseconds. The searches measure
+    // their share on the clock type, the CPU time of their thread or the wall-
+    // clock time, and return the best preference found when it runs out.
+    base::Clock::Diff time_limit;
+    base::Clock::Type clock_type;
+    // Whether IRV preferences are searched exactly instead of randomly.
+    bool exact;
+  };
 };
 }  // namespace bush
 #endif  // SRC_VOTING_SYSTEM_H_